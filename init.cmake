@@ -5,3 +5,7 @@ set(CMAKE_ARCHIVE_OUTPUT_DIRECTORY "${CMAKE_BINARY_DIR}")
 set(CMAKE_LIBRARY_OUTPUT_DIRECTORY "${CMAKE_BINARY_DIR}")
 set(CMAKE_RUNTIME_OUTPUT_DIRECTORY "${CMAKE_BINARY_DIR}")
 
+
+# most verbose log level compiled in: ERROR, WARN, INFO, or DEBUG
+set(LOG_COMPILE_LEVEL "DEBUG" CACHE STRING "Most verbose log level compiled in")
+add_definitions(-DLOG_COMPILE_LEVEL=${LOG_COMPILE_LEVEL})
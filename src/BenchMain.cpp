@@ -0,0 +1,396 @@
+//-----------------------------------------------------------------------------
+// Copyright (c) 2017 Shawn Chidester, All rights reserved
+//-----------------------------------------------------------------------------
+#include "utils/Platform.h"
+#include "utils/CommandArgs.h"
+#include "utils/Error.h"
+#include "utils/Logger.h"
+#include "utils/Msg.h"
+#include "utils/Random.h"
+#include "utils/Timer.h"
+#include "subsim/Simulation.h"
+
+using namespace subsim;
+
+//-----------------------------------------------------------------------------
+static const Direction DIRECTIONS[] = { North, East, South, West };
+static Random rng;
+
+//-----------------------------------------------------------------------------
+static bool isOpen(const GameMap& gameMap, const Coordinate& coord) {
+  return (gameMap.contains(coord) && !gameMap.getSquare(coord).isBlocked());
+}
+
+//-----------------------------------------------------------------------------
+static Submarine::Equipment randomCharge(const Submarine& sub) {
+  std::vector<Submarine::Equipment> candidates;
+  if (sub.getSonarCharge() < sub.getMaxSonarCharge()) {
+    candidates.push_back(Submarine::Sonar);
+  }
+  if (sub.getTorpedoCharge() < sub.getMaxTorpedoCharge()) {
+    candidates.push_back(Submarine::Torpedo);
+  }
+  if (sub.getMineCharge() < sub.getMaxMineCharge()) {
+    candidates.push_back(Submarine::Mine);
+  }
+  if (sub.getSprintCharge() < sub.getMaxSprintCharge()) {
+    candidates.push_back(Submarine::Sprint);
+  }
+  return candidates.empty() ? Submarine::None
+                            : candidates[rng(candidates.size())];
+}
+
+//-----------------------------------------------------------------------------
+static Command randomCommand(const Game& game,
+                             const Player& player,
+                             const unsigned subID)
+{
+  const GameMap& gameMap = game.getMap();
+  const Submarine& sub = player.getSubmarine(subID);
+  const Coordinate& from = sub.getLocation();
+  const unsigned playerID = player.getPlayerID();
+  const unsigned turn = game.getTurnNumber();
+
+  std::vector<Direction> dirs;
+  for (const Direction dir : DIRECTIONS) {
+    if (isOpen(gameMap, from + dir)) {
+      dirs.push_back(dir);
+    }
+  }
+
+  if ((sub.getShieldCount() < sub.getMaxShields()) && !rng(8)) {
+    return SurfaceCommand(playerID, turn, subID);
+  }
+
+  if ((sub.getTorpedoRange() > 1) && !rng(3)) {
+    const unsigned range = sub.getTorpedoRange();
+    Coordinate dest(from);
+    for (unsigned i = rng(range) + 1; i > 0; --i) {
+      const Coordinate next(dest + DIRECTIONS[rng(4)]);
+      if (isOpen(gameMap, next)) {
+        dest = next;
+      }
+    }
+    if (dest != from) {
+      return FireCommand(playerID, turn, subID, dest);
+    }
+  }
+
+  if ((sub.getMineCharge() >= sub.getMaxMineCharge()) && dirs.size()) {
+    const Direction dir = dirs[rng(dirs.size())];
+    return MineCommand(playerID, turn, subID, dir);
+  }
+
+  if ((sub.getSonarCharge() > 2) && !rng(4)) {
+    return PingCommand(playerID, turn, subID);
+  }
+
+  if ((sub.getSprintRange() > 1) && !rng(4)) {
+    const Direction dir = DIRECTIONS[rng(4)];
+    if (isOpen(gameMap, from + dir) && isOpen(gameMap, from + dir + dir)) {
+      return SprintCommand(playerID, turn, subID, dir, 2);
+    }
+  }
+
+  const Submarine::Equipment equip = randomCharge(sub);
+  if (dirs.size() && (equip != Submarine::None)) {
+    const Direction dir = dirs[rng(dirs.size())];
+    return MoveCommand(playerID, turn, subID, dir, equip);
+  }
+
+  return SleepCommand(playerID, turn, subID, equip, randomCharge(sub));
+}
+
+//-----------------------------------------------------------------------------
+static Coordinate randomLocation(const GameMap& gameMap) {
+  while (true) {
+    const Coordinate coord((rng(gameMap.getWidth()) + 1),
+                           (rng(gameMap.getHeight()) + 1));
+    if (isOpen(gameMap, coord)) {
+      return coord;
+    }
+  }
+}
+
+//-----------------------------------------------------------------------------
+// Rollouts use tryCommand() so a rejected command doesn't cost the player
+// its seat in the game the rollout will be restored to
+//-----------------------------------------------------------------------------
+static bool addRandomCommands(Simulation& sim, const bool rollout = false) {
+  bool ordered = false;
+  std::string err;
+  for (const PlayerPtr& player : sim.getGame().getPlayers()) {
+    for (unsigned subID = 0; subID < player->getSubmarineCount(); ++subID) {
+      if (player->getSubmarine(subID).isActive()) {
+        const Command command = randomCommand(sim.getGame(), (*player), subID);
+        ordered |= rollout ? sim.tryCommand(command, err)
+                           : sim.addCommand(command);
+      }
+    }
+  }
+  return ordered;
+}
+
+//-----------------------------------------------------------------------------
+static void clearMessages(Simulation& sim) {
+  for (const SimPlayerPtr& player : sim.getPlayers()) {
+    player->clearMessages();
+  }
+}
+
+//-----------------------------------------------------------------------------
+// Try the current turn with random commands the given number of times,
+// restoring the game after each try.  The rng is put back afterwards so a
+// game plays out the same with or without rollouts.
+//-----------------------------------------------------------------------------
+static void playRollouts(Simulation& sim,
+                         GameState& state,
+                         const unsigned rollouts)
+{
+  const Random saved(rng);
+  sim.saveState(state);
+  for (unsigned i = 0; i < rollouts; ++i) {
+    addRandomCommands(sim, true);
+    sim.simulateTurn();
+    sim.restoreState(state);
+  }
+  rng = saved;
+}
+
+//-----------------------------------------------------------------------------
+static unsigned runGame(Simulation& sim,
+                        const GameConfig& config,
+                        const unsigned playerCount,
+                        const unsigned rollouts,
+                        const std::string& logFile)
+{
+  sim.reset(config, "bench", rng.next(), logFile);
+
+  const GameMap& gameMap = sim.getGame().getMap();
+  for (unsigned i = 0; i < playerCount; ++i) {
+    std::vector<Coordinate> coords;
+    for (unsigned n = 0; n < config.getSubsPerPlayer(); ++n) {
+      coords.push_back(randomLocation(gameMap));
+    }
+    sim.addPlayer(("bot" + toStr(i + 1)), coords);
+  }
+
+  GameState state;
+  sim.start();
+  while (!sim.isFinished()) {
+    if (rollouts) {
+      playRollouts(sim, state, rollouts);
+    }
+    const bool ordered = addRandomCommands(sim);
+    if (ordered && !sim.allCommandsReceived()) {
+      throw Error(Msg() << "Turn " << sim.getTurnNumber()
+                  << " not ready after all commands submitted");
+    }
+    sim.executeTurn();
+    clearMessages(sim);
+  }
+
+  return sim.getTurnNumber();
+}
+
+//-----------------------------------------------------------------------------
+// Scripted games for cases random play rarely reaches, each one reports
+// whether it played out as expected
+//-----------------------------------------------------------------------------
+static GameConfig checkConfig() {
+  GameConfig config;
+  config.addSetting(GameSetting(GameSetting::MinPlayers, 2));
+  config.addSetting(GameSetting(GameSetting::MaxPlayers, 2));
+  config.addSetting(GameSetting(GameSetting::SubsPerPlayer, 2));
+  config.addSetting(GameSetting(GameSetting::MapSize,
+                                std::vector<unsigned>{20, 20}));
+  config.validate();
+  return config;
+}
+
+//-----------------------------------------------------------------------------
+static bool checkColocatedMeltdowns() {
+  // both subs of bot1 share a square and idle until their reactors blow
+  // in the same turn, the first blast destroys the second sub
+  Simulation sim;
+  sim.reset(checkConfig(), "check", 1);
+  sim.addPlayer("bot1", {Coordinate(5, 5), Coordinate(5, 5)});
+  sim.addPlayer("bot2", {Coordinate(15, 15), Coordinate(18, 18)});
+  sim.start();
+  while (!sim.isFinished() && (sim.getTurnNumber() <= 10)) {
+    for (const PlayerPtr& player : sim.getGame().getPlayers()) {
+      for (unsigned subID = 0; subID < player->getSubmarineCount(); ++subID) {
+        if (player->getSubmarine(subID).isActive()) {
+          sim.addCommand(SleepCommand(player->getPlayerID(),
+                                      sim.getTurnNumber(), subID,
+                                      Submarine::None, Submarine::None));
+        }
+      }
+    }
+    sim.executeTurn();
+  }
+
+  const PlayerPtr bot1 = sim.getGame().getPlayer("bot1");
+  return (bot1 && bot1->getSubmarine(0).isDead() &&
+          bot1->getSubmarine(1).isDead());
+}
+
+//-----------------------------------------------------------------------------
+static bool checkRejectedLookahead() {
+  // a second order for the same sub is rejected without removing bot1,
+  // so the saved state still fits the game
+  Simulation sim;
+  sim.reset(checkConfig(), "check", 1);
+  sim.addPlayer("bot1", {Coordinate(5, 5), Coordinate(8, 8)});
+  sim.addPlayer("bot2", {Coordinate(15, 15), Coordinate(18, 18)});
+  sim.start();
+
+  GameState state;
+  std::string err;
+  const SleepCommand sleep(sim.getPlayers().front()->getPlayerID(),
+                           sim.getTurnNumber(), 0,
+                           Submarine::Sonar, Submarine::Torpedo);
+  sim.saveState(state);
+  if (!sim.tryCommand(sleep, err) || sim.tryCommand(sleep, err)) {
+    return false;
+  }
+  sim.simulateTurn();
+  sim.restoreState(state);
+  return (sim.getGame().getPlayerCount() == 2);
+}
+
+//-----------------------------------------------------------------------------
+static bool checkSilentLookahead() {
+  // players only hear about turns that were executed for real
+  Simulation sim;
+  sim.reset(checkConfig(), "check", 1);
+  sim.addPlayer("bot1", {Coordinate(5, 5), Coordinate(8, 8)});
+  sim.addPlayer("bot2", {Coordinate(15, 15), Coordinate(18, 18)});
+  sim.start();
+
+  GameState state;
+  const std::size_t count = sim.getPlayers().front()->getMessages().size();
+  sim.saveState(state);
+  addRandomCommands(sim, true);
+  sim.simulateTurn();
+  sim.restoreState(state);
+  return (sim.getPlayers().front()->getMessages().size() == count);
+}
+
+//-----------------------------------------------------------------------------
+static int runChecks() {
+  struct Check {
+    const char* name;
+    bool (*run)();
+  };
+  const Check checks[] = {
+    { "co-located meltdowns", checkColocatedMeltdowns },
+    { "rejected lookahead command", checkRejectedLookahead },
+    { "silent lookahead turn", checkSilentLookahead }
+  };
+
+  unsigned failed = 0;
+  for (const Check& check : checks) {
+    bool ok = false;
+    try {
+      ok = check.run();
+    } catch (const std::exception& e) {
+      std::cout << check.name << ": " << e.what() << '\n';
+    }
+    std::cout << check.name << (ok ? " ok" : " FAILED") << std::endl;
+    failed += !ok;
+  }
+  return failed ? 1 : 0;
+}
+
+//-----------------------------------------------------------------------------
+int main(const int argc, const char* argv[]) {
+  try {
+    CommandArgs::initialize(argc, argv);
+    const CommandArgs& args = CommandArgs::getInstance();
+
+    if (args.has("--help")) {
+      std::cout << "usage: " << args.getProgramName() << " [options]\n"
+                << "  -n, --games <count>    Number of games to play\n"
+                << "  -p, --players <count>  Players per game\n"
+                << "  -s, --subs <count>     Submarines per player\n"
+                << "  -m, --map <size>       Map width and height\n"
+                << "  -o, --obstacles <n>    Obstacles placed on the map\n"
+                << "  -t, --turns <count>    Maximum turns per game\n"
+                << "  -r, --rollouts <n>     Try each turn <n> times first\n"
+                << "  --seed <value>         Random number seed\n"
+                << "  --check                Play the scripted checks and exit\n"
+                << "  -g, --game-log <file>  Write game log to <file>\n"
+                << "  -l, --log-level <lvl>  DEBUG, INFO, WARN, or ERROR\n"
+                << "  -f, --log-file <file>  Write log messages to <file>\n";
+      return 0;
+    }
+
+    Logger::getInstance(); // applies --log-level and --log-file
+
+    if (args.has("--check")) {
+      return runChecks();
+    }
+
+    const unsigned games   = args.getUIntAfter({"-n", "--games"}, 100);
+    const unsigned players = args.getUIntAfter({"-p", "--players"}, 4);
+    const unsigned subs    = args.getUIntAfter({"-s", "--subs"}, 2);
+    const unsigned mapSize = args.getUIntAfter({"-m", "--map"}, 40);
+    const unsigned blocked = args.getUIntAfter({"-o", "--obstacles"}, 0);
+    const unsigned turns   = args.getUIntAfter({"-t", "--turns"}, 500);
+    const unsigned rollouts = args.getUIntAfter({"-r", "--rollouts"}, 0);
+    const std::string seed = args.getStrAfter("--seed");
+    const std::string gameLog = args.getStrAfter({"-g", "--game-log"});
+
+    GameConfig config;
+    config.addSetting(GameSetting(GameSetting::MinPlayers, players));
+    config.addSetting(GameSetting(GameSetting::MaxPlayers, players));
+    config.addSetting(GameSetting(GameSetting::MaxTurns, turns));
+    config.addSetting(GameSetting(GameSetting::SubsPerPlayer, subs));
+    config.addSetting(GameSetting(GameSetting::MapSize,
+                                  std::vector<unsigned>{mapSize, mapSize}));
+
+    rng.setSeed(seed.size() ? toUInt64(seed) : Random::newSeed());
+    std::cout << "seed " << rng.getSeed() << std::endl;
+
+    std::set<Coordinate> obstacles;
+    const unsigned obstacleCount = std::min<unsigned>(blocked,
+                                                      (mapSize * mapSize / 2));
+    while (obstacles.size() < obstacleCount) {
+      obstacles.insert(Coordinate((rng(mapSize) + 1), (rng(mapSize) + 1)));
+    }
+    for (const Coordinate& coord : obstacles) {
+      config.addSetting(GameSetting(GameSetting::Obstacle,
+          std::vector<unsigned>{coord.getX(), coord.getY()}));
+    }
+    config.validate();
+
+    Simulation sim;
+    Timer timer;
+    uint64_t totalTurns = 0;
+    for (unsigned i = 0; i < games; ++i) {
+      totalTurns += runGame(sim, config, players, rollouts, gameLog);
+    }
+
+    const Milliseconds elapsed = std::max<Milliseconds>(1, timer.elapsed());
+    std::cout << games << " games, " << totalTurns << " turns in "
+              << elapsed << " ms: "
+              << ((games * 1000.0) / elapsed) << " games/sec, "
+              << ((totalTurns * 1000.0) / elapsed) << " turns/sec"
+              << std::endl;
+    if (rollouts) {
+      const uint64_t totalRollouts = (totalTurns * rollouts);
+      std::cout << totalRollouts << " rollouts: "
+                << ((totalRollouts * 1000.0) / elapsed) << " rollouts/sec"
+                << std::endl;
+    }
+    return 0;
+  }
+  catch (const std::exception& e) {
+    std::cerr << e.what() << std::endl;
+  }
+  catch (...) {
+    std::cerr << "Unhandled exception" << std::endl;
+  }
+  return 1;
+}
@@ -0,0 +1,82 @@
+//-----------------------------------------------------------------------------
+// Copyright (c) 2017 Shawn Chidester, All rights reserved
+//-----------------------------------------------------------------------------
+#include "utils/Platform.h"
+#include "utils/CommandArgs.h"
+#include "utils/Error.h"
+#include "utils/Msg.h"
+#include "subsim/BinaryGameLogReader.h"
+#include <iostream>
+
+using namespace subsim;
+
+//-----------------------------------------------------------------------------
+static void listGames(BinaryGameLogReader& reader) {
+  std::string line;
+  const auto& games = reader.getGames();
+  for (unsigned i = 0; i < games.size(); ++i) {
+    reader.seek(i);
+    reader.next(line);
+    std::cout << "game " << (i + 1) << ": " << games[i].turns.size()
+              << " turns, " << games[i].names.size() << " players, "
+              << line << '\n';
+  }
+}
+
+//-----------------------------------------------------------------------------
+int main(const int argc, const char* argv[]) {
+  try {
+    CommandArgs::initialize(argc, argv);
+    const CommandArgs& args = CommandArgs::getInstance();
+
+    if ((args.getCount() < 1) || args.has("--help")) {
+      std::cout << "usage: " << args.getProgramName()
+                << " [options] <binary-game-log>\n"
+                << "Print a binary game log in the text game log format.\n"
+                << "  --list                 List the games in the log\n"
+                << "  -g, --game <number>    Only print the given game\n"
+                << "  -t, --turn <number>    Start at the given turn\n"
+                << "  -n, --turns <count>    Stop after <count> turns\n";
+      return 0;
+    }
+
+    BinaryGameLogReader reader;
+    reader.open(args.get(args.getCount() - 1));
+    if (args.has("--list")) {
+      listGames(reader);
+      return 0;
+    }
+
+    const unsigned game = args.getUIntAfter({"-g", "--game"}, 0);
+    const unsigned turn = args.getUIntAfter({"-t", "--turn"}, 0);
+    const unsigned turns = args.getUIntAfter({"-n", "--turns"}, 0);
+    if (game || turn) {
+      reader.seek((game ? (game - 1) : 0), turn);
+    }
+
+    std::string line;
+    unsigned turnCount = 0;
+    bool started = false;
+    while (reader.next(line)) {
+      const auto type = reader.getRecordType();
+      if ((type == BinaryGameLog::Config) && started && (game || turn)) {
+        break; // end of the selected game
+      } else if ((type == BinaryGameLog::Turn) && turns &&
+                 (++turnCount > turns))
+      {
+        break;
+      }
+      std::cout << line << '\n';
+      started = true;
+    }
+    std::cout.flush();
+    return 0;
+  }
+  catch (const std::exception& e) {
+    std::cerr << e.what() << std::endl;
+  }
+  catch (...) {
+    std::cerr << "Unhandled exception" << std::endl;
+  }
+  return 1;
+}
@@ -0,0 +1,146 @@
+//-----------------------------------------------------------------------------
+// Copyright (c) 2017 Shawn Chidester, All rights reserved
+//-----------------------------------------------------------------------------
+#include "utils/Platform.h"
+#include "utils/CommandArgs.h"
+#include "utils/Error.h"
+#include "utils/Logger.h"
+#include "utils/Msg.h"
+#include "utils/Timer.h"
+#include "subsim/BinaryGameLogReader.h"
+#include "subsim/Replay.h"
+#include <fstream>
+#include <iostream>
+
+using namespace subsim;
+
+//-----------------------------------------------------------------------------
+struct Totals {
+  unsigned games = 0;
+  unsigned fileGames = 0; // games replayed from the current file
+  unsigned mismatches = 0;
+  uint64_t turns = 0;
+};
+
+//-----------------------------------------------------------------------------
+static bool isBinaryLog(const std::string& fileName) {
+  std::ifstream file(fileName, std::ios_base::binary);
+  std::string head(BinaryGameLog::MAGIC.size() + 2, 0);
+  if (!file) {
+    throw Error(Msg() << "Failed to open '" << fileName << "'");
+  }
+  return (file.read(&head[0], head.size()) &&
+          (head[1] == BinaryGameLog::Header) &&
+          !head.compare(2, BinaryGameLog::MAGIC.size(), BinaryGameLog::MAGIC));
+}
+
+//-----------------------------------------------------------------------------
+static void replayGame(Replay& replay,
+                       const std::string& fileName,
+                       const std::vector<std::string>& lines,
+                       const bool verbose,
+                       Totals& totals)
+{
+  if (lines.empty()) {
+    return;
+  }
+
+  const std::string error = replay.run(lines);
+  totals.games++;
+  totals.fileGames++;
+  totals.turns += replay.getGame().getTurnNumber();
+  if (error.size()) {
+    totals.mismatches++;
+    std::cout << fileName << " game " << totals.fileGames << ": " << error
+              << '\n';
+  } else if (verbose) {
+    std::cout << fileName << " game " << totals.fileGames << ": "
+              << replay.getGame().getTurnNumber() << " turns ok\n";
+  }
+}
+
+//-----------------------------------------------------------------------------
+// Split the file into games at their NEW_GAME lines and replay each one
+//-----------------------------------------------------------------------------
+static void replayFile(Replay& replay,
+                       const std::string& fileName,
+                       const bool verbose,
+                       Totals& totals)
+{
+  std::vector<std::string> lines;
+  std::string line;
+  totals.fileGames = 0;
+  auto addLine = [&]() {
+    if (!line.compare(0, 10, "NEW_GAME: ")) {
+      replayGame(replay, fileName, lines, verbose, totals);
+      lines.clear();
+    }
+    if (lines.size() || !line.compare(0, 10, "NEW_GAME: ")) {
+      lines.push_back(line);
+    }
+  };
+
+  if (isBinaryLog(fileName)) {
+    BinaryGameLogReader reader;
+    reader.open(fileName);
+    while (reader.next(line)) {
+      addLine();
+    }
+  } else {
+    std::ifstream file(fileName);
+    while (std::getline(file, line)) {
+      addLine();
+    }
+  }
+  replayGame(replay, fileName, lines, verbose, totals);
+}
+
+//-----------------------------------------------------------------------------
+int main(const int argc, const char* argv[]) {
+  try {
+    CommandArgs::initialize(argc, argv);
+    const CommandArgs& args = CommandArgs::getInstance();
+
+    if ((args.getCount() < 1) || args.has("--help")) {
+      std::cout << "usage: " << args.getProgramName()
+                << " [options] <game-log> [<game-log> ...]\n"
+                << "Replay the games in text or binary game logs and report\n"
+                << "the first line of each game the server no longer repeats.\n"
+                << "  -v, --verbose          Report games that match too\n"
+                << "  -l, --log-level <lvl>  DEBUG, INFO, WARN, or ERROR\n"
+                << "  -f, --log-file <file>  Write log messages to <file>\n";
+      return 0;
+    }
+
+    Logger::getInstance(); // applies --log-level and --log-file
+
+    const bool verbose = (args.has("-v") || args.has("--verbose"));
+    Replay replay;
+    Totals totals;
+    Timer timer;
+    for (int i = 0; i < args.getCount(); ++i) {
+      const std::string arg = args.get(i);
+      if ((arg == "-l") || (arg == "--log-level") ||
+          (arg == "-f") || (arg == "--log-file"))
+      {
+        i++;
+      } else if (!args.isSwitch(i)) {
+        replayFile(replay, arg, verbose, totals);
+      }
+    }
+
+    const Milliseconds elapsed = std::max<Milliseconds>(1, timer.elapsed());
+    std::cout << totals.games << " games, " << totals.turns << " turns, "
+              << totals.mismatches << " mismatched in " << elapsed << " ms: "
+              << ((totals.games * 1000.0) / elapsed) << " games/sec"
+              << std::endl;
+    return totals.mismatches ? 1 : 0;
+  }
+  catch (const std::exception& e) {
+    std::cerr << e.what() << std::endl;
+  }
+  catch (...) {
+    std::cerr << "Unhandled exception" << std::endl;
+  }
+  return 1;
+}
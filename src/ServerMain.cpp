@@ -5,6 +5,7 @@
 #include "utils/CommandArgs.h"
 #include "utils/Logger.h"
 #include "utils/Screen.h"
+#include "subsim/Lobby.h"
 #include "subsim/Server.h"
 #include <csignal>
 
@@ -12,23 +13,32 @@ using namespace subsim;
 
 //-----------------------------------------------------------------------------
 void termSizeChanged(int) {
-  Screen::get(true);
+  Screen::resized();
 }
 
 //-----------------------------------------------------------------------------
 int main(const int argc, const char* argv[]) {
   try {
-    initRandom();
     CommandArgs::initialize(argc, argv);
     Server server;
 
-    signal(SIGWINCH, termSizeChanged);
     signal(SIGPIPE, SIG_IGN);
 
     if (!server.init()) {
       return 1;
     }
 
+    if (!server.isHeadless()) {
+      signal(SIGWINCH, termSizeChanged);
+    }
+
+    const unsigned rooms = CommandArgs::getInstance().getUIntAfter("--lobby",
+                                                                  0);
+    if (rooms) {
+      Lobby lobby;
+      return lobby.run(rooms) ? 0 : 1;
+    }
+
     while (server.run() && server.isRepeatOn()) { }
     return 0;
   }
@@ -7,6 +7,7 @@
 #include "utils/Logger.h"
 #include "utils/Msg.h"
 #include "utils/StringUtils.h"
+#include <fstream>
 
 namespace subsim
 {
@@ -45,11 +46,11 @@ FileSysDBRecord::load() {
 
   std::ifstream file(filePath.c_str());
   if (!file) {
-    Logger::debug() << "File '" << filePath << "' does not exist";
+    LOG_DEBUG << "File '" << filePath << "' does not exist";
     return;
   } else {
-    Logger::debug() << "Loading '" << filePath << "' as record ID '"
-                    << recordID << "'";
+    LOG_DEBUG << "Loading '" << filePath << "' as record ID '"
+              << recordID << "'";
   }
 
   unsigned line = 0;
@@ -78,8 +79,8 @@ FileSysDBRecord::load() {
     }
     it->second.push_back(val);
 
-    Logger::debug() << "Loaded " << filePath << '@' << line << ": '" << fld
-                    << "'='" << val << "'";
+    LOG_DEBUG << "Loaded " << filePath << '@' << line << ": '" << fld
+              << "'='" << val << "'";
   }
 }
 
@@ -0,0 +1,381 @@
+//-----------------------------------------------------------------------------
+// Copyright (c) 2017 Shawn Chidester, All rights reserved
+//-----------------------------------------------------------------------------
+#include "BinaryGameLog.h"
+#include "utils/Logger.h"
+#include <algorithm>
+#include <cstring>
+#include <fstream>
+
+namespace subsim
+{
+
+//-----------------------------------------------------------------------------
+const std::string BinaryGameLog::MAGIC("SSGL");
+
+//-----------------------------------------------------------------------------
+static const std::string NEW_GAME("NEW_GAME: ");
+static const std::string SEED("SEED: ");
+static const std::string SERVER_ALL("SERVER ALL: ");
+static const std::string SERVER("SERVER ");
+static const std::string PLAYER("PLAYER ");
+static const std::string NAME_END(": ");
+
+//-----------------------------------------------------------------------------
+static bool startsWith(const std::string& str, const std::string& prefix) {
+  return !str.compare(0, prefix.size(), prefix);
+}
+
+//-----------------------------------------------------------------------------
+// Only digit strings that print back the same way are stored as numbers
+//-----------------------------------------------------------------------------
+static bool toNumber(const char* begin, const char* end, uint64_t& value) {
+  const std::size_t len = (end - begin);
+  if (!len || (len > BinaryGameLog::MAX_DIGITS) ||
+      ((len > 1) && (*begin == '0')))
+  {
+    return false;
+  }
+  value = 0;
+  for (const char* p = begin; p < end; ++p) {
+    if ((*p < '0') || (*p > '9')) {
+      return false;
+    }
+    value = ((value * 10) + (*p - '0'));
+  }
+  return true;
+}
+
+//-----------------------------------------------------------------------------
+BinaryGameLog::Buffer::int_type
+BinaryGameLog::Buffer::overflow(int_type ch) {
+  if (!traits_type::eq_int_type(ch, traits_type::eof())) {
+    if (traits_type::to_char_type(ch) == '\n') {
+      log.encode();
+    } else {
+      log.line += traits_type::to_char_type(ch);
+    }
+  }
+  return traits_type::not_eof(ch);
+}
+
+//-----------------------------------------------------------------------------
+std::streamsize
+BinaryGameLog::Buffer::xsputn(const char* data, std::streamsize count) {
+  const char* end = (data + count);
+  for (const char* p = data; p < end; ) {
+    const char* eol = static_cast<const char*>(memchr(p, '\n', (end - p)));
+    if (!eol) {
+      log.line.append(p, (end - p));
+      break;
+    }
+    log.line.append(p, (eol - p));
+    log.encode();
+    p = (eol + 1);
+  }
+  return count;
+}
+
+//-----------------------------------------------------------------------------
+int
+BinaryGameLog::Buffer::sync() {
+  return log.writer.flush() ? 0 : -1;
+}
+
+//-----------------------------------------------------------------------------
+BinaryGameLog::BinaryGameLog()
+  : std::ostream(nullptr),
+    buffer(*this)
+{
+  rdbuf(&buffer);
+  setstate(std::ios_base::badbit); // until opened
+}
+
+//-----------------------------------------------------------------------------
+void
+BinaryGameLog::putVarint(std::string& dest, uint64_t value) {
+  while (value >= 0x80) {
+    dest += static_cast<char>((value & 0x7F) | 0x80);
+    value >>= 7;
+  }
+  dest += static_cast<char>(value);
+}
+
+//-----------------------------------------------------------------------------
+void
+BinaryGameLog::putString(std::string& dest,
+                         const char* str,
+                         const std::size_t len)
+{
+  putVarint(dest, len);
+  dest.append(str, len);
+}
+
+//-----------------------------------------------------------------------------
+bool
+BinaryGameLog::getVarint(const std::string& src,
+                         std::size_t& pos,
+                         uint64_t& value) noexcept
+{
+  value = 0;
+  for (unsigned shift = 0; (pos < src.size()) && (shift < 64); shift += 7) {
+    const unsigned char byte = static_cast<unsigned char>(src[pos++]);
+    value |= (static_cast<uint64_t>(byte & 0x7F) << shift);
+    if (!(byte & 0x80)) {
+      return true;
+    }
+  }
+  return false;
+}
+
+//-----------------------------------------------------------------------------
+bool
+BinaryGameLog::getString(const std::string& src,
+                         std::size_t& pos,
+                         std::string& value)
+{
+  uint64_t len;
+  if (!getVarint(src, pos, len) || (len > (src.size() - pos))) {
+    return false;
+  }
+  value.assign(src, pos, len);
+  pos += len;
+  return true;
+}
+
+//-----------------------------------------------------------------------------
+bool
+BinaryGameLog::open(const std::string& name, const bool sync) {
+  close();
+
+  // appending to an existing log continues its index chain
+  uint64_t size = 0;
+  std::ifstream existing(name, std::ios_base::binary);
+  if (existing && existing.seekg(0, std::ios_base::end)) {
+    size = static_cast<uint64_t>(existing.tellg());
+  }
+  if (size) {
+    std::string head(std::min<uint64_t>(size, 32), 0);
+    existing.seekg(0);
+    existing.read(&head[0], head.size());
+    if ((head.size() < (MAGIC.size() + 2)) || (head[1] != Header) ||
+        head.compare(2, MAGIC.size(), MAGIC))
+    {
+      Logger::error() << "'" << name << "' is not a binary game log";
+      return false;
+    }
+    if (size >= FOOTER_SIZE) {
+      char footer[FOOTER_SIZE];
+      existing.seekg(size - FOOTER_SIZE);
+      if (existing.read(footer, FOOTER_SIZE) &&
+          (footer[0] == (FOOTER_SIZE - 1)) && (footer[1] == Footer))
+      {
+        for (unsigned i = FOOTER_SIZE; i-- > 2; ) {
+          lastIndex <<= 8;
+          lastIndex |= static_cast<unsigned char>(footer[i]);
+        }
+      }
+    }
+  }
+  existing.close();
+
+  if (!writer.open(name, sync)) {
+    lastIndex = 0;
+    return false;
+  }
+
+  offset = size;
+  clear();
+  if (!size) {
+    payload = MAGIC;
+    putVarint(payload, VERSION);
+    putRecord(Header, payload);
+  }
+  return true;
+}
+
+//-----------------------------------------------------------------------------
+void
+BinaryGameLog::close() {
+  if (!isOpen()) {
+    return;
+  }
+
+  if (line.size()) {
+    encode();
+  }
+  endGame();
+  if (lastIndex) {
+    payload.clear();
+    for (unsigned i = 0; i < 8; ++i) {
+      payload += static_cast<char>((lastIndex >> (8 * i)) & 0xFF);
+    }
+    putRecord(Footer, payload);
+  }
+
+  writer.close();
+  offset = lastIndex = 0;
+  setstate(std::ios_base::badbit);
+}
+
+//-----------------------------------------------------------------------------
+void
+BinaryGameLog::addName(const std::string& name) {
+  if (!names.count(name)) {
+    names[name] = nameTable.size();
+    nameTable.push_back(name);
+  }
+}
+
+//-----------------------------------------------------------------------------
+// Players are referred to by their index in the game's name table, names
+// that weren't announced with a join get a Name record first
+//-----------------------------------------------------------------------------
+void
+BinaryGameLog::putPlayer(const std::string& name) {
+  auto it = names.find(name);
+  if (it == names.end()) {
+    std::string data;
+    putString(data, name.data(), name.size());
+    putRecord(Name, data);
+    addName(name);
+    it = names.find(name);
+  }
+  putVarint(payload, it->second);
+}
+
+//-----------------------------------------------------------------------------
+void
+BinaryGameLog::putFields(std::string& dest,
+                         const char* begin,
+                         const char* end)
+{
+  putVarint(dest, (std::count(begin, end, '|') + 1));
+  while (true) {
+    const char* sep = std::find(begin, end, '|');
+    uint64_t number;
+    if (toNumber(begin, sep, number)) {
+      putVarint(dest, (number << 1));
+    } else {
+      putVarint(dest, ((static_cast<uint64_t>(sep - begin) << 1) | 1));
+      dest.append(begin, (sep - begin));
+    }
+    if (sep == end) {
+      break;
+    }
+    begin = (sep + 1);
+  }
+}
+
+//-----------------------------------------------------------------------------
+void
+BinaryGameLog::putRecord(const RecordType type, const std::string& data) {
+  frame.clear();
+  putVarint(frame, (data.size() + 1));
+  frame += static_cast<char>(type);
+  writer.write(frame.data(), frame.size());
+  writer.write(data.data(), data.size());
+  offset += (frame.size() + data.size());
+}
+
+//-----------------------------------------------------------------------------
+// Write the index of the game in progress, if any
+//-----------------------------------------------------------------------------
+void
+BinaryGameLog::endGame() {
+  if (!gameOffset) {
+    return;
+  }
+
+  std::string index;
+  putVarint(index, gameOffset);
+  putVarint(index, lastIndex);
+  putVarint(index, nameTable.size());
+  for (const std::string& name : nameTable) {
+    putString(index, name.data(), name.size());
+  }
+  putVarint(index, turns.size());
+  for (const TurnOffset& turn : turns) {
+    putVarint(index, turn.turn);
+    putVarint(index, (turn.offset - gameOffset));
+  }
+
+  lastIndex = offset;
+  putRecord(Index, index);
+  gameOffset = 0;
+  names.clear();
+  nameTable.clear();
+  turns.clear();
+}
+
+//-----------------------------------------------------------------------------
+// Store the completed text line as the record type that fits it best
+//-----------------------------------------------------------------------------
+void
+BinaryGameLog::encode() {
+  const char* begin = line.data();
+  const char* end = (begin + line.size());
+  RecordType type = Text;
+  payload.clear();
+
+  if (startsWith(line, NEW_GAME)) {
+    endGame();
+    gameOffset = offset;
+    type = Config;
+    putFields(payload, (begin + NEW_GAME.size()), end);
+  } else if (startsWith(line, SEED)) {
+    uint64_t seed;
+    if (toNumber((begin + SEED.size()), end, seed)) {
+      type = Seed;
+      putVarint(payload, seed);
+    }
+  } else if (startsWith(line, SERVER_ALL)) {
+    const char* msg = (begin + SERVER_ALL.size());
+    const bool tagged = (((end - msg) > 1) && (msg[1] == '|'));
+    const char* body = tagged ? (msg + 2) : end;
+    const char* sep = std::find(body, end, '|');
+    uint64_t turn;
+    type = Broadcast;
+    if (!tagged) {
+      putFields(payload, msg, end);
+    } else if ((*msg == 'J') && (sep == end)) {
+      type = Join;
+      addName(std::string(body, end));
+      putString(payload, body, (end - body));
+    } else if ((*msg == 'P') && (sep != end)) {
+      type = Result;
+      putPlayer(std::string(body, sep));
+      putFields(payload, (sep + 1), end);
+    } else if ((*msg == 'B') && toNumber(body, sep, turn)) {
+      type = Turn;
+      turns.push_back(TurnOffset{static_cast<unsigned>(turn), offset});
+      putFields(payload, body, end);
+    } else if (*msg == 'V') {
+      type = Setting;
+      putFields(payload, body, end);
+    } else if (*msg == 'D') {
+      type = Detonation;
+      putFields(payload, body, end);
+    } else if (*msg == 'F') {
+      type = Finish;
+      putFields(payload, body, end);
+    } else {
+      putFields(payload, msg, end);
+    }
+  } else if (startsWith(line, SERVER) || startsWith(line, PLAYER)) {
+    const std::size_t pos = line.find(NAME_END, SERVER.size());
+    if (pos != std::string::npos) {
+      type = (line[0] == 'S') ? Message : Command;
+      putPlayer(line.substr(SERVER.size(), (pos - SERVER.size())));
+      putFields(payload, (begin + pos + NAME_END.size()), end);
+    }
+  }
+
+  if (type == Text) {
+    payload = line;
+  }
+  putRecord(type, payload);
+  line.clear();
+}
+
+} // namespace subsim
@@ -0,0 +1,150 @@
+//-----------------------------------------------------------------------------
+// Copyright (c) 2017 Shawn Chidester, All rights reserved
+//-----------------------------------------------------------------------------
+#ifndef SUBSIM_BINARY_GAME_LOG_H
+#define SUBSIM_BINARY_GAME_LOG_H
+
+#include "utils/Platform.h"
+#include "utils/LogWriter.h"
+#include <map>
+#include <ostream>
+
+namespace subsim
+{
+
+//-----------------------------------------------------------------------------
+// A compact binary stand-in for the text game log.  It takes the same text
+// lines the game writes ("NEW_GAME: ...", "SERVER ALL: ...", "PLAYER x: ...")
+// and stores each one as a typed record:
+//
+//   record  = varint size, type byte, payload (size counts type + payload)
+//   fields  = varint count, then per field a varint head: (n << 1) for a
+//             plain decimal number n, ((len << 1) | 1) + bytes otherwise
+//   player  = varint index into the game's name table (Join/Name records)
+//
+// Turn records (B|<turn>) are indexed.  When a game ends an Index record
+// lists its turn offsets, and closing the file appends a fixed size Footer
+// that points at the last Index, so readers can jump straight to any turn.
+// BinaryGameLogReader turns the records back into the original text lines.
+//-----------------------------------------------------------------------------
+class BinaryGameLog : public std::ostream {
+//-----------------------------------------------------------------------------
+public: // enums
+  enum RecordType : unsigned char {
+    Header = 1, // magic and format version, first record in the file
+    Config,     // NEW_GAME: <fields>, starts a game
+    Seed,       // SEED: <number>
+    Name,       // <string>, adds a player name to the table, no text
+    Setting,    // SERVER ALL: V|<fields>
+    Join,       // SERVER ALL: J|<string>, adds the name to the table
+    Turn,       // SERVER ALL: B|<fields>
+    Detonation, // SERVER ALL: D|<fields>
+    Finish,     // SERVER ALL: F|<fields>
+    Result,     // SERVER ALL: P|<player>|<fields>
+    Broadcast,  // SERVER ALL: <fields>
+    Message,    // SERVER <player>: <fields>
+    Command,    // PLAYER <player>: <fields>
+    Text,       // any other line, verbatim
+    Index,      // game offset, previous index offset, names, turn offsets
+    Footer      // last index offset as 8 bytes little endian
+  };
+
+  enum {
+    VERSION = 1,
+    FOOTER_SIZE = 10, // size byte + type byte + 8 byte offset
+    MAX_DIGITS = 18   // longest decimal field stored as a number
+  };
+
+//-----------------------------------------------------------------------------
+public: // constants
+  static const std::string MAGIC;
+
+//-----------------------------------------------------------------------------
+public: // typedefs
+  struct TurnOffset {
+    unsigned turn;
+    uint64_t offset;
+  };
+
+//-----------------------------------------------------------------------------
+private: // types
+  class Buffer : public std::streambuf {
+    BinaryGameLog& log;
+
+  public:
+    explicit Buffer(BinaryGameLog& log) noexcept : log(log) { }
+
+  protected:
+    int_type overflow(int_type ch) override;
+    std::streamsize xsputn(const char* data, std::streamsize count) override;
+    int sync() override;
+  };
+
+//-----------------------------------------------------------------------------
+private: // variables
+  Buffer buffer;
+  LogWriter writer;
+  std::string line;    // text collected since the last '\n'
+  std::string payload; // encode buffer
+  std::string frame;   // size and type of the record being written
+  uint64_t offset = 0;       // file offset of the next record
+  uint64_t lastIndex = 0;    // offset of the last Index record, 0 = none
+  uint64_t gameOffset = 0;   // offset of the current Config record, 0 = none
+  std::map<std::string, unsigned> names;
+  std::vector<std::string> nameTable;
+  std::vector<TurnOffset> turns;
+
+//-----------------------------------------------------------------------------
+public: // constructors
+  BinaryGameLog();
+  BinaryGameLog(BinaryGameLog&&) = delete;
+  BinaryGameLog(const BinaryGameLog&) = delete;
+  BinaryGameLog& operator=(BinaryGameLog&&) = delete;
+  BinaryGameLog& operator=(const BinaryGameLog&) = delete;
+
+//-----------------------------------------------------------------------------
+public: // destructor
+  ~BinaryGameLog() { close(); }
+
+//-----------------------------------------------------------------------------
+public: // static methods
+  static void putVarint(std::string& dest, uint64_t value);
+  static void putString(std::string& dest, const char* str, std::size_t len);
+  static bool getVarint(const std::string& src, std::size_t& pos,
+                        uint64_t& value) noexcept;
+  static bool getString(const std::string& src, std::size_t& pos,
+                        std::string& value);
+
+//-----------------------------------------------------------------------------
+public: // methods
+  bool isOpen() const noexcept { return writer.isOpen(); }
+  const std::string& getFileName() const noexcept {
+    return writer.getFileName();
+  }
+
+  /**
+   * @brief Open the given file for appending binary game records
+   * @param fileName The file to append to, must be empty or a binary log
+   * @param sync If true flush() waits until output is on disk
+   * @return false if the file could not be opened
+   */
+  bool open(const std::string& fileName, const bool sync = false);
+
+  /**
+   * @brief Index the current game, write the footer, and close the file
+   */
+  void close();
+
+//-----------------------------------------------------------------------------
+private: // methods
+  void encode();
+  void endGame();
+  void putFields(std::string& dest, const char* begin, const char* end);
+  void putPlayer(const std::string& name);
+  void putRecord(const RecordType, const std::string& data);
+  void addName(const std::string& name);
+};
+
+} // namespace subsim
+
+#endif // SUBSIM_BINARY_GAME_LOG_H
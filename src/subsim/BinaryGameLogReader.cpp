@@ -0,0 +1,366 @@
+//-----------------------------------------------------------------------------
+// Copyright (c) 2017 Shawn Chidester, All rights reserved
+//-----------------------------------------------------------------------------
+#include "BinaryGameLogReader.h"
+#include "utils/Error.h"
+#include "utils/Msg.h"
+#include <algorithm>
+
+namespace subsim
+{
+
+//-----------------------------------------------------------------------------
+void
+BinaryGameLogReader::open(const std::string& name) {
+  fileName = name;
+  games.clear();
+  names.clear();
+
+  file.close();
+  file.clear();
+  file.open(name, std::ios_base::binary);
+  if (!file || !file.seekg(0, std::ios_base::end)) {
+    throw Error(Msg() << "Failed to open '" << name << "'");
+  }
+  fileSize = static_cast<uint64_t>(file.tellg());
+
+  seekTo(0);
+  if (!readRecord() || (recordType != BinaryGameLog::Header) ||
+      record.compare(1, BinaryGameLog::MAGIC.size(), BinaryGameLog::MAGIC))
+  {
+    throw Error(Msg() << "'" << name << "' is not a binary game log");
+  }
+  dataStart = position;
+
+  if (!loadIndex()) {
+    scanIndex();
+  }
+  seekTo(dataStart);
+}
+
+//-----------------------------------------------------------------------------
+void
+BinaryGameLogReader::seek(const unsigned game, const unsigned turn) {
+  if (game >= games.size()) {
+    throw Error(Msg() << "'" << fileName << "' has no game " << (game + 1));
+  }
+
+  const GameInfo& info = games[game];
+  if (!turn) {
+    seekTo(info.offset);
+    return;
+  }
+
+  for (const BinaryGameLog::TurnOffset& turnOffset : info.turns) {
+    if (turnOffset.turn == turn) {
+      names = info.names;
+      seekTo(turnOffset.offset);
+      return;
+    }
+  }
+  throw Error(Msg() << "Game " << (game + 1) << " has no turn " << turn);
+}
+
+//-----------------------------------------------------------------------------
+bool
+BinaryGameLogReader::next(std::string& line) {
+  while (readRecord()) {
+    std::size_t pos = 1;
+    std::string name;
+    uint64_t value;
+
+    line.clear();
+    switch (recordType) {
+    case BinaryGameLog::Header:
+    case BinaryGameLog::Index:
+    case BinaryGameLog::Footer:
+      continue;
+    case BinaryGameLog::Name:
+      if (!BinaryGameLog::getString(record, pos, name)) {
+        corrupt("player name");
+      }
+      addName(name);
+      continue;
+    case BinaryGameLog::Config:
+      names.clear();
+      line = "NEW_GAME: ";
+      getFields(pos, line);
+      break;
+    case BinaryGameLog::Seed:
+      if (!BinaryGameLog::getVarint(record, pos, value)) {
+        corrupt("seed");
+      }
+      line = ("SEED: " + std::to_string(value));
+      break;
+    case BinaryGameLog::Setting:
+      line = "SERVER ALL: V|";
+      getFields(pos, line);
+      break;
+    case BinaryGameLog::Join:
+      if (!BinaryGameLog::getString(record, pos, name)) {
+        corrupt("player name");
+      }
+      addName(name);
+      line = ("SERVER ALL: J|" + name);
+      break;
+    case BinaryGameLog::Turn:
+      line = "SERVER ALL: B|";
+      getFields(pos, line);
+      break;
+    case BinaryGameLog::Detonation:
+      line = "SERVER ALL: D|";
+      getFields(pos, line);
+      break;
+    case BinaryGameLog::Finish:
+      line = "SERVER ALL: F|";
+      getFields(pos, line);
+      break;
+    case BinaryGameLog::Result:
+      line = "SERVER ALL: P|";
+      line += getName(pos);
+      line += '|';
+      getFields(pos, line);
+      break;
+    case BinaryGameLog::Broadcast:
+      line = "SERVER ALL: ";
+      getFields(pos, line);
+      break;
+    case BinaryGameLog::Message:
+      line = "SERVER ";
+      line += getName(pos);
+      line += ": ";
+      getFields(pos, line);
+      break;
+    case BinaryGameLog::Command:
+      line = "PLAYER ";
+      line += getName(pos);
+      line += ": ";
+      getFields(pos, line);
+      break;
+    case BinaryGameLog::Text:
+      line.assign(record, 1, std::string::npos);
+      break;
+    default:
+      corrupt("record type");
+    }
+    return true;
+  }
+  return false;
+}
+
+//-----------------------------------------------------------------------------
+// Follow the Index chain back from the footer, false if there is no footer
+// or the chain doesn't reach all the way back to the first game
+//-----------------------------------------------------------------------------
+bool
+BinaryGameLogReader::loadIndex() {
+  if (fileSize < (dataStart + BinaryGameLog::FOOTER_SIZE)) {
+    return false;
+  }
+
+  char footer[BinaryGameLog::FOOTER_SIZE];
+  seekTo(fileSize - BinaryGameLog::FOOTER_SIZE);
+  if (!file.read(footer, BinaryGameLog::FOOTER_SIZE) ||
+      (footer[0] != (BinaryGameLog::FOOTER_SIZE - 1)) ||
+      (footer[1] != BinaryGameLog::Footer))
+  {
+    return false;
+  }
+
+  uint64_t indexOffset = 0;
+  for (unsigned i = BinaryGameLog::FOOTER_SIZE; i-- > 2; ) {
+    indexOffset <<= 8;
+    indexOffset |= static_cast<unsigned char>(footer[i]);
+  }
+
+  std::vector<GameInfo> chain;
+  uint64_t limit = fileSize;
+  while (indexOffset) {
+    if ((indexOffset < dataStart) || (indexOffset >= limit)) {
+      return false;
+    }
+
+    seekTo(indexOffset);
+    if (!readRecord() || (recordType != BinaryGameLog::Index)) {
+      return false;
+    }
+
+    GameInfo info;
+    std::size_t pos = 1;
+    uint64_t prev, count, turn, delta;
+    if (!BinaryGameLog::getVarint(record, pos, info.offset) ||
+        !BinaryGameLog::getVarint(record, pos, prev) ||
+        !BinaryGameLog::getVarint(record, pos, count))
+    {
+      return false;
+    }
+    info.names.resize(std::min<uint64_t>(count, record.size()));
+    for (std::string& name : info.names) {
+      if (!BinaryGameLog::getString(record, pos, name)) {
+        return false;
+      }
+    }
+    if (!BinaryGameLog::getVarint(record, pos, count)) {
+      return false;
+    }
+    for (uint64_t i = 0; i < count; ++i) {
+      if (!BinaryGameLog::getVarint(record, pos, turn) ||
+          !BinaryGameLog::getVarint(record, pos, delta))
+      {
+        return false;
+      }
+      info.turns.push_back(BinaryGameLog::TurnOffset{
+          static_cast<unsigned>(turn), (info.offset + delta)});
+    }
+
+    chain.push_back(std::move(info));
+    limit = indexOffset;
+    indexOffset = prev;
+  }
+
+  if (chain.empty() || (chain.back().offset != dataStart)) {
+    return false;
+  }
+
+  games.assign(std::make_move_iterator(chain.rbegin()),
+               std::make_move_iterator(chain.rend()));
+  return true;
+}
+
+//-----------------------------------------------------------------------------
+void
+BinaryGameLogReader::scanIndex() {
+  games.clear();
+  seekTo(dataStart);
+  while (true) {
+    const uint64_t offset = position;
+    try {
+      if (!readRecord()) {
+        break;
+      }
+    } catch (const Error&) {
+      break; // partial record at the end of the file, next() will report it
+    }
+
+    std::size_t pos = 1;
+    std::string name;
+    uint64_t count, head;
+    switch (recordType) {
+    case BinaryGameLog::Config:
+      games.emplace_back();
+      games.back().offset = offset;
+      names.clear();
+      break;
+    case BinaryGameLog::Join:
+    case BinaryGameLog::Name:
+      if (games.size() && BinaryGameLog::getString(record, pos, name)) {
+        addName(name);
+        games.back().names = names;
+      }
+      break;
+    case BinaryGameLog::Turn:
+      if (games.size() && BinaryGameLog::getVarint(record, pos, count) &&
+          BinaryGameLog::getVarint(record, pos, head) && !(head & 1))
+      {
+        games.back().turns.push_back(BinaryGameLog::TurnOffset{
+            static_cast<unsigned>(head >> 1), offset});
+      }
+      break;
+    default:
+      break;
+    }
+  }
+  names.clear();
+}
+
+//-----------------------------------------------------------------------------
+void
+BinaryGameLogReader::seekTo(const uint64_t offset) {
+  file.clear();
+  file.seekg(offset);
+  position = offset;
+}
+
+//-----------------------------------------------------------------------------
+bool
+BinaryGameLogReader::readRecord() {
+  uint64_t size = 0;
+  for (unsigned shift = 0; ; shift += 7) {
+    const int ch = file.get();
+    if (ch == EOF) {
+      if (shift) {
+        corrupt("record size");
+      }
+      return false;
+    }
+    position++;
+    size |= (static_cast<uint64_t>(ch & 0x7F) << shift);
+    if (!(ch & 0x80)) {
+      break;
+    } else if (shift >= 63) {
+      corrupt("record size");
+    }
+  }
+
+  if (!size || (size > (fileSize - position))) {
+    corrupt("record size");
+  }
+  record.resize(size);
+  if (!file.read(&record[0], size)) {
+    corrupt("record");
+  }
+  position += size;
+  recordType = static_cast<RecordType>(record[0]);
+  return true;
+}
+
+//-----------------------------------------------------------------------------
+void
+BinaryGameLogReader::addName(const std::string& name) {
+  if (std::find(names.begin(), names.end(), name) == names.end()) {
+    names.push_back(name);
+  }
+}
+
+//-----------------------------------------------------------------------------
+void
+BinaryGameLogReader::corrupt(const std::string& what) const {
+  throw Error(Msg() << "'" << fileName << "' has a corrupt " << what
+              << " before offset " << position);
+}
+
+//-----------------------------------------------------------------------------
+void
+BinaryGameLogReader::getFields(std::size_t& pos, std::string& dest) const {
+  uint64_t count, head;
+  if (!BinaryGameLog::getVarint(record, pos, count)) {
+    corrupt("field count");
+  }
+  for (uint64_t i = 0; i < count; ++i) {
+    if (i) {
+      dest += '|';
+    }
+    if (!BinaryGameLog::getVarint(record, pos, head)) {
+      corrupt("field");
+    } else if (!(head & 1)) {
+      dest += std::to_string(head >> 1);
+    } else if ((head >> 1) > (record.size() - pos)) {
+      corrupt("field");
+    } else {
+      dest.append(record, pos, (head >> 1));
+      pos += (head >> 1);
+    }
+  }
+}
+
+//-----------------------------------------------------------------------------
+const std::string&
+BinaryGameLogReader::getName(std::size_t& pos) const {
+  uint64_t idx;
+  if (!BinaryGameLog::getVarint(record, pos, idx) || (idx >= names.size())) {
+    corrupt("player index");
+  }
+  return names[idx];
+}
+
+} // namespace subsim
@@ -0,0 +1,92 @@
+//-----------------------------------------------------------------------------
+// Copyright (c) 2017 Shawn Chidester, All rights reserved
+//-----------------------------------------------------------------------------
+#ifndef SUBSIM_BINARY_GAME_LOG_READER_H
+#define SUBSIM_BINARY_GAME_LOG_READER_H
+
+#include "utils/Platform.h"
+#include "BinaryGameLog.h"
+#include <fstream>
+
+namespace subsim
+{
+
+//-----------------------------------------------------------------------------
+// Reads a file written by BinaryGameLog back as the text game log lines it
+// was made from.  The game and turn index comes from the Index records
+// chained from the footer; files without a complete chain (a server that
+// didn't shut down cleanly) are indexed with one pass over the records.
+//-----------------------------------------------------------------------------
+class BinaryGameLogReader {
+//-----------------------------------------------------------------------------
+public: // typedefs
+  typedef BinaryGameLog::RecordType RecordType;
+
+  struct GameInfo {
+    uint64_t offset = 0; // of the game's Config record
+    std::vector<std::string> names;
+    std::vector<BinaryGameLog::TurnOffset> turns;
+  };
+
+//-----------------------------------------------------------------------------
+private: // variables
+  std::string fileName;
+  std::ifstream file;
+  std::string record;
+  uint64_t fileSize = 0;
+  uint64_t position = 0; // offset of the next record
+  uint64_t dataStart = 0; // offset of the first record after the header
+  RecordType recordType = BinaryGameLog::Header;
+  std::vector<GameInfo> games;
+  std::vector<std::string> names; // name table of the game being read
+
+//-----------------------------------------------------------------------------
+public: // constructors
+  BinaryGameLogReader() = default;
+  BinaryGameLogReader(BinaryGameLogReader&&) = delete;
+  BinaryGameLogReader(const BinaryGameLogReader&) = delete;
+  BinaryGameLogReader& operator=(BinaryGameLogReader&&) = delete;
+  BinaryGameLogReader& operator=(const BinaryGameLogReader&) = delete;
+
+//-----------------------------------------------------------------------------
+public: // methods
+  const std::vector<GameInfo>& getGames() const noexcept { return games; }
+  RecordType getRecordType() const noexcept { return recordType; }
+
+  /**
+   * @brief Open the given binary game log and load its index
+   * @throws Error if the file can't be read or isn't a binary game log
+   */
+  void open(const std::string& fileName);
+
+  /**
+   * @brief Continue reading at the start of the given game or turn
+   * @param game Index into getGames()
+   * @param turn Turn number to start at, 0 = start of the game
+   * @throws Error if there is no such game or turn
+   */
+  void seek(const unsigned game, const unsigned turn = 0);
+
+  /**
+   * @brief Read the next text log line
+   * @param line Set to the line, without a trailing newline
+   * @return false at end of file
+   * @throws Error if the file is corrupt
+   */
+  bool next(std::string& line);
+
+//-----------------------------------------------------------------------------
+private: // methods
+  bool loadIndex();
+  bool readRecord();
+  void scanIndex();
+  void seekTo(const uint64_t offset);
+  void addName(const std::string& name);
+  void corrupt(const std::string& what) const;
+  void getFields(std::size_t& pos, std::string& dest) const;
+  const std::string& getName(std::size_t& pos) const;
+};
+
+} // namespace subsim
+
+#endif // SUBSIM_BINARY_GAME_LOG_READER_H
@@ -24,8 +24,7 @@ enum {
 //-----------------------------------------------------------------------------
 bool
 Game::addCommand(const int handle, Input& input, std::string& err) {
-  PlayerPtr player = getPlayer(handle);
-  if (!player) {
+  if (!getPlayer(handle)) {
     throw Error(Msg() << "Game::addCommand() Invalid player handle: "
                 << handle);
   }
@@ -38,32 +37,9 @@ Game::addCommand(const int handle, Input& input, std::string& err) {
     return false;
   }
 
-  std::set<unsigned> subIDs;
-  const unsigned playerID = static_cast<unsigned>(handle);
-  for (const auto& command : commands) {
-    if (command->getPlayerID() == playerID) {
-      subIDs.insert(command->getSubID());
-    }
-  }
-
   if (input.getFieldCount() < 3) {
     err = "Command messages must begin with turn number and sub ID";
     return false;
-
-    const unsigned tn = input.getUInt(1, ~0U);
-    if (tn != turnNumber) {
-    }
-    err = ("Invalid turn number: " + input.getStr(1));
-    return false;
-  }
-
-  const unsigned subID = input.getUInt(2, ~0U);
-  if (subID >= config.getSubsPerPlayer()) {
-    err = ("Invalid sub ID: " + input.getStr(2));
-    return false;
-  } else if (subIDs.count(subID)) {
-    err = ("Multiple commands for sub ID " + toStr(subID));
-    return false;
   }
 
   const std::string type = input.getStr();
@@ -72,47 +48,30 @@ Game::addCommand(const int handle, Input& input, std::string& err) {
     return false;
   }
 
-  const Submarine& sub = player->getSubmarine(subID);
-  if (sub.isDead()) {
-    err = ("Command submitted for dead sub ID" + toStr(subID));
-    return false;
-  } else if (sub.getSurfaceTurns()) {
-    err = ("Command submitted for surfaced sub ID " + toStr(subID));
-    return false;
-  } else if (!sub.isActive()) {
-    err = ("Command submitted for inactive sub ID " + toStr(subID));
-    return false;
-  }
-
+  Command command;
+  const unsigned playerID = static_cast<unsigned>(handle);
   try {
     switch (type[0]) {
     case MineCommand::TYPE:
-      commands.push_back(
-            std::unique_ptr<Command>(new MineCommand(playerID, input)));
+      command = MineCommand(playerID, input);
       break;
     case FireCommand::TYPE:
-      commands.push_back(
-            std::unique_ptr<Command>(new FireCommand(playerID, input)));
+      command = FireCommand(playerID, input);
       break;
     case MoveCommand::TYPE:
-      commands.push_back(
-            std::unique_ptr<Command>(new MoveCommand(playerID, input)));
+      command = MoveCommand(playerID, input);
       break;
     case PingCommand::TYPE:
-      commands.push_back(
-            std::unique_ptr<Command>(new PingCommand(playerID, input)));
+      command = PingCommand(playerID, input);
       break;
     case SprintCommand::TYPE:
-      commands.push_back(
-            std::unique_ptr<Command>(new SprintCommand(playerID, input)));
+      command = SprintCommand(playerID, input);
       break;
     case SleepCommand::TYPE:
-      commands.push_back(
-            std::unique_ptr<Command>(new SleepCommand(playerID, input)));
+      command = SleepCommand(playerID, input);
       break;
     case SurfaceCommand::TYPE:
-      commands.push_back(
-            std::unique_ptr<Command>(new SurfaceCommand(playerID, input)));
+      command = SurfaceCommand(playerID, input);
       break;
     default:
       err = ("Invalid command type: " + type);
@@ -123,19 +82,79 @@ Game::addCommand(const int handle, Input& input, std::string& err) {
     return false;
   }
 
+  return addCommand(handle, command, err);
+}
+
+//-----------------------------------------------------------------------------
+bool
+Game::addCommand(const int handle, const Command& command, std::string& err) {
+  PlayerPtr player = getPlayer(handle);
+  if (!player) {
+    throw Error(Msg() << "Game::addCommand() Invalid player handle: "
+                << handle);
+  } else if (command.getPlayerID() != static_cast<unsigned>(handle)) {
+    throw Error(Msg() << "Game::addCommand() command player ID ("
+                << command.getPlayerID() << ") does not match handle "
+                << handle);
+  } else if ((command.getType() <= Command::Invalid) ||
+             (command.getType() > Command::Ping))
+  {
+    throw Error(Msg() << "Game::addCommand() invalid command type: "
+                << command.getType());
+  }
+
+  if (!isStarted()) {
+    err = "Game has not started";
+    return false;
+  } else if (isFinished()) {
+    err = "Game is finished";
+    return false;
+  } else if (command.getTurnNumber() != turnNumber) {
+    err = ("Invalid turn number: " + toStr(command.getTurnNumber()));
+    return false;
+  }
+
+  const unsigned subID = command.getSubID();
+  if (subID >= config.getSubsPerPlayer()) {
+    err = ("Invalid sub ID: " + toStr(subID));
+    return false;
+  }
+
+  const unsigned order = ((playerSlots[handle] * config.getSubsPerPlayer()) +
+                          subID);
+  if (subOrders[order]) {
+    err = ("Multiple commands for sub ID " + toStr(subID));
+    return false;
+  }
+
+  SubmarinePtr sub = player->getSubmarinePtr(subID);
+  if (sub->isDead()) {
+    err = ("Command submitted for dead sub ID " + toStr(subID));
+    return false;
+  } else if (sub->getSurfaceTurns()) {
+    err = ("Command submitted for surfaced sub ID " + toStr(subID));
+    return false;
+  } else if (!sub->isActive()) {
+    err = ("Command submitted for inactive sub ID " + toStr(subID));
+    return false;
+  }
+
+  CommandQueue& queue = commandQueues[command.getType()];
+  queue.push_back(QueuedCommand{player, sub, command});
+  commandCount++;
+  subOrders[order] = true;
+  pendingCommands--;
   return true;
 }
 
 //-----------------------------------------------------------------------------
 PlayerPtr
 Game::getPlayer(const int handle) const {
-  if (handle > 0) {
-    for (auto it = players.begin(); it != players.end(); ++it) {
-      const PlayerPtr& player = it->second;
-      if (player->handle() == handle) {
-        ASSERT(player->getPlayerID() == static_cast<unsigned>(handle));
-        return player;
-      }
+  if ((handle > 0) && (static_cast<unsigned>(handle) < playerSlots.size())) {
+    const unsigned slot = playerSlots[handle];
+    if (slot < players.size()) {
+      ASSERT(players[slot]->handle() == handle);
+      return players[slot];
     }
   }
   return nullptr;
@@ -145,8 +164,7 @@ Game::getPlayer(const int handle) const {
 PlayerPtr
 Game::getPlayer(const std::string name) const {
   if (!isEmpty(name)) {
-    for (auto it = players.begin(); it != players.end(); ++it) {
-      const PlayerPtr& player = it->second;
+    for (const PlayerPtr& player : players) {
       if (iEqual(player->getName(), name)) {
         return player;
       }
@@ -155,24 +173,12 @@ Game::getPlayer(const std::string name) const {
   return nullptr;
 }
 
-//-----------------------------------------------------------------------------
-std::vector<PlayerPtr>
-Game::getPlayers() const {
-  std::vector<PlayerPtr> result;
-  result.reserve(players.size());
-  for (auto it = players.begin(); it != players.end(); ++it) {
-    result.push_back(it->second);
-  }
-  return std::move(result);
-}
-
 //-----------------------------------------------------------------------------
 std::vector<PlayerPtr>
 Game::playersFromAddress(const std::string address) const {
   std::vector<PlayerPtr> result;
   if (!isEmpty(address)) {
-    for (auto it = players.begin(); it != players.end(); ++it) {
-      const PlayerPtr& player = it->second;
+    for (const PlayerPtr& player : players) {
       if (player->getAddress() == address) {
         result.push_back(player);
       }
@@ -190,17 +196,22 @@ Game::printSummary(Coordinate& coord) const {
 
 //-----------------------------------------------------------------------------
 void
-Game::reset(const GameConfig& gameConfig, const std::string& gameTitle) {
+Game::reset(const GameConfig& gameConfig,
+           const std::string& gameTitle,
+           const uint64_t seed)
+{
   title = gameTitle;
   config = gameConfig;
+  rng.setSeed(seed);
   gameMap.reset(config.getMapWidth(), config.getMapHeight());
   started = 0;
   aborted = 0;
   finished = 0;
   turnNumber = 0;
+  clearCommands();
 
   for (const Coordinate& coord : config.getObstacles()) {
-    gameMap.addObject(coord, std::make_unique<Obstacle>());
+    gameMap.addObstacle(coord);
   }
 }
 
@@ -237,30 +248,49 @@ Game::start(std::ostream& gameLog) {
   turnNumber = 0;
   torpedoShots.clear();
   nuclearDetonations.clear();
-  detonations.clear();
-  spotted.clear();
-  sprints.clear();
-  discovered.clear();
-  torpedoHits.clear();
-  mineHits.clear();
+  events.clear();
   errs.clear();
 
+  gameLog << "SEED: " << rng.getSeed() << '\n';
+  countPendingCommands();
+
+  // each sub gets at most one command per turn, so the queues never grow
+  const unsigned maxCommands = (players.size() * config.getSubsPerPlayer());
+  for (CommandQueue& queue : commandQueues) {
+    queue.reserve(maxCommands);
+  }
+
   // send initial info messages
-  for (auto it = players.begin(); it != players.end(); ++it) {
-    PlayerPtr player = it->second;
-    sendSubInfo(gameLog, (*player));
+  for (PlayerPtr& player : players) {
+    queueSubInfo(gameLog, (*player));
     // TODO handle custom game start state
   }
 
   // set begin turn message
   turnNumber = 1;
-  sendToAll(gameLog, Msg('B') << turnNumber);
+  queueToAll(gameLog, broadcastTail, Msg('B') << turnNumber);
+  gameLog.flush(); // on record before any player hears of it
+  flushAll();
   return errs;
 }
 
 //-----------------------------------------------------------------------------
 std::string
 Game::addPlayer(PlayerPtr player, Input& input) {
+  std::vector<Coordinate> coords;
+  for (unsigned i = 2; (i + 1) < input.getFieldCount(); i += 2) {
+    coords.push_back(Coordinate(input.getUInt(i), input.getUInt(i + 1)));
+  }
+  if ((input.getFieldCount() % 2) != 0) {
+    // odd trailing value, let the count check below reject it
+    coords.push_back(Coordinate());
+  }
+  return addPlayer(player, coords);
+}
+
+//-----------------------------------------------------------------------------
+std::string
+Game::addPlayer(PlayerPtr player, const std::vector<Coordinate>& coords) {
   if (!player) {
     throw Error("Game::addPlayer() null player");
   } else if (started) {
@@ -273,9 +303,26 @@ Game::addPlayer(PlayerPtr player, Input& input) {
   } else if (getPlayer(player->getName())) {
     throw Error(Msg() << "Game::addPlayer() duplicate player name: "
                 << player->getName());
+  } else if (getPlayer(player->handle())) {
+    throw Error(Msg() << "Game::addPlayer() duplicate player handle: "
+                << player->handle());
+  }
+
+  // verify all starting locations before creating any submarines
+  const unsigned subCount = config.getSubmarineConfigs().size();
+  for (unsigned subID = 0; subID < subCount; ++subID) {
+    const Coordinate coord = (subID < coords.size()) ? coords[subID]
+                                                     : Coordinate();
+    if (!gameMap.contains(coord)) {
+      return Msg() << "Missing or invalid coordinates for sub ID " << subID;
+    } else if (gameMap.getSquare(coord).isBlocked()) {
+      return Msg() << "Coordinate " << coord << " is blocked";
+    }
+  }
+  if (coords.size() != subCount) {
+    return "Incorrect number of submarine coordinate values";
   }
 
-  unsigned i = 2; // input field index
   unsigned subID = 0;
   for (const Submarine& subConfig : config.getSubmarineConfigs()) {
     // double check sub ID
@@ -284,16 +331,6 @@ Game::addPlayer(PlayerPtr player, Input& input) {
                   << " on sub config " << subID);
     }
 
-    // verify sub has a valid starting location
-    Coordinate coord;
-    const unsigned x = input.getUInt(i++);
-    const unsigned y = input.getUInt(i++);
-    if (!gameMap.contains(coord.set(x, y))) {
-      return Msg() << "Missing or invalid coordinates for sub ID " << subID;
-    } else if (gameMap.getSquare(coord).isBlocked()) {
-      return Msg() << "Coordinate " << coord << " is blocked";
-    }
-
     // create sub from template specified in the game config
     SubmarinePtr sub = std::make_shared<Submarine>(
           player->handle(), player->getMapChar(), subID, subConfig);
@@ -302,25 +339,27 @@ Game::addPlayer(PlayerPtr player, Input& input) {
     if (gameMap.contains(subConfig.getLocation())) {
       sub->setLocation(subConfig.getLocation());
     } else {
-      sub->setLocation(coord);
+      sub->setLocation(coords[subID]);
     }
 
     // add submarine to player
     player->addSubmarine(sub);
     subID++;
   }
-  if (i != input.getFieldCount()) {
-    return "Incorrect number of submarine coordinate values";
-  }
 
-  // add player to player map
-  players[player->handle()] = player;
+  // add player to player table
+  const unsigned handle = static_cast<unsigned>(player->handle());
+  if (handle >= playerSlots.size()) {
+    playerSlots.resize((handle + 1), ~0U);
+  }
+  playerSlots[handle] = players.size();
+  players.push_back(player);
 
   // add player submarines to game map
   for (unsigned subID = 0; subID < player->getSubmarineCount(); ++subID) {
     SubmarinePtr sub = player->getSubmarinePtr(subID);
     if (sub->getLocation()) {
-      gameMap.addObject(sub->getLocation(), sub);
+      gameMap.addObject(sub->getLocation(), sub.get());
     }
   }
 
@@ -330,27 +369,48 @@ Game::addPlayer(PlayerPtr player, Input& input) {
 //-----------------------------------------------------------------------------
 void
 Game::removePlayer(const int handle) {
-  for (auto it = commands.begin(); it != commands.end(); ) {
-    const UniqueCommand& command = (*it);
-    if (command->getPlayerID() == static_cast<unsigned>(handle)) {
-      it = commands.erase(it);
-    } else {
-      it++;
+  for (CommandQueue& queue : commandQueues) {
+    auto end = std::remove_if(queue.begin(), queue.end(),
+                              [handle](const QueuedCommand& queued) {
+      return (queued.player->handle() == handle);
+    });
+    commandCount -= static_cast<unsigned>(queue.end() - end);
+    queue.erase(end, queue.end());
+  }
+  if ((handle > 0) && (static_cast<unsigned>(handle) < playerSlots.size())) {
+    const unsigned slot = playerSlots[handle];
+    if (slot < players.size()) {
+      removeSlot(slot);
     }
   }
-  for (auto it = players.begin(); it != players.end(); ++it) {
-    PlayerPtr player = it->second;
-    if (player->handle() == handle) {
-      for (unsigned subID = 0; subID < player->getSubmarineCount(); ++subID) {
-        SubmarinePtr sub = player->getSubmarinePtr(subID);
-        if (sub->getLocation()) {
-          gameMap.removeObject(sub->getLocation(), sub);
-        }
-      }
-      players.erase(it);
-      return;
+}
+
+//-----------------------------------------------------------------------------
+void
+Game::removeSlot(const unsigned slot) {
+  PlayerPtr player = players[slot];
+  const unsigned firstOrder = (slot * config.getSubsPerPlayer());
+  for (unsigned subID = 0; subID < player->getSubmarineCount(); ++subID) {
+    SubmarinePtr sub = player->getSubmarinePtr(subID);
+    if (sub->getLocation()) {
+      gameMap.removeObject(sub->getLocation(), sub.get());
+    }
+    if (started && sub->isActive() && !subOrders[firstOrder + subID]) {
+      pendingCommands--;
     }
   }
+
+  if (started) {
+    subOrders.erase((subOrders.begin() + firstOrder),
+                    (subOrders.begin() + firstOrder +
+                     config.getSubsPerPlayer()));
+  }
+
+  playerSlots[player->handle()] = ~0U;
+  players.erase(players.begin() + slot);
+  for (unsigned i = slot; i < players.size(); ++i) {
+    playerSlots[players[i]->handle()] = i;
+  }
 }
 
 //-----------------------------------------------------------------------------
@@ -365,16 +425,14 @@ Game::saveResults(Database& db) const {
   unsigned hits = 0;
   unsigned highScore = 0;
   unsigned lowScore = ~0U;
-  for (auto it = players.begin(); it != players.end(); ++it) {
-    const PlayerPtr& player = it->second;
+  for (const PlayerPtr& player : players) {
     hits += player->getScore();
     highScore = std::max<unsigned>(highScore, player->getScore());
     lowScore = std::min<unsigned>(lowScore, player->getScore());
   }
 
   unsigned ties = 0;
-  for (auto it = players.begin(); it != players.end(); ++it) {
-    const PlayerPtr& player = it->second;
+  for (const PlayerPtr& player : players) {
     ties += (player->getScore() == highScore);
   }
   if (ties > 0) {
@@ -413,8 +471,7 @@ Game::saveResults(Database& db) const {
   stats->setUInt("last.hits", hits);
   stats->setUInt("last.ties", ties);
 
-  for (auto it = players.begin(); it != players.end(); ++it) {
-    const PlayerPtr& player = it->second;
+  for (const PlayerPtr& player : players) {
     const bool first = (player->getScore() == highScore);
     const bool last = (player->getScore() == lowScore);
     player->addStatsTo(*stats, first, last);
@@ -447,170 +504,93 @@ Game::canStart() const noexcept {
 //-----------------------------------------------------------------------------
 bool
 Game::allCommandsReceived() const noexcept {
-  if (!started || isFinished() || commands.empty()) {
-    return false;
-  }
-
-  std::map<unsigned, std::set<unsigned>> ids;
-  for (auto it = players.begin(); it != players.end(); ++it) {
-    const PlayerPtr& player = it->second;
-    if (!player) {
-      throw Error("Null player in game.players map");
-    }
-    for (unsigned subID = 0; subID < player->getSubmarineCount(); ++subID) {
-      const Submarine& sub = player->getSubmarine(subID);
-      if (sub.isActive()) {
-        ids[player->getPlayerID()].insert(subID);
-      }
-    }
-  }
-
-  if (ids.empty()) {
-    return false;
-  }
-
-  for (auto it = commands.begin(); it != commands.end(); ++it) {
-    const UniqueCommand& commandPtr = (*it);
-    if (!commandPtr) {
-      throw Error("Null command in command list");
-    }
-
-    const Command& command = (*commandPtr);
-    if (command.getType() == Command::Invalid) {
-      throw Error("Invalid command in command list");
-    } else if (command.getTurnNumber() != turnNumber) {
-      throw Error(Msg() << "Incorrect turn number (" << command.getTurnNumber()
-                  << " in command from command list");
-    }
-
-    auto player = ids.find(command.getPlayerID());
-    if (player == ids.end()) {
-      throw Error(Msg() << "Command for dead player ID ("
-                  << command.getPlayerID() << ") in command list");
-    }
-
-    auto sub = player->second.find(command.getSubID());
-    if (sub == player->second.end()) {
-      throw Error(Msg() << "Command for dead sub ID (" << command.getSubID()
-                  << ") player ID (" << command.getPlayerID()
-                  << ") in command list");
-    }
-
-    player->second.erase(sub);
-    if (player->second.empty()) {
-      ids.erase(player);
-    }
-  }
-
-  return ids.empty();
+  return (started && !isFinished() && commandCount && !pendingCommands);
 }
 
 //-----------------------------------------------------------------------------
 void
-Game::sendToAll(std::ostream& gameLog, const std::string& message) {
-  gameLog << "SERVER ALL: " << message << std::endl;
-  for (auto it = players.begin(); it != players.end(); ++it) {
-    PlayerPtr& player = it->second;
-    if (player) {
-      sendTo(nullptr, (*player), message);
-    }
-  }
+Game::queueToAll(std::ostream& gameLog,
+                 std::string& buffer,
+                 const std::string& message)
+{
+  gameLog << "SERVER ALL: " << message << '\n';
+  buffer += message;
+  buffer += '\n';
 }
 
 //-----------------------------------------------------------------------------
-bool
-Game::sendTo(std::ostream* gameLog,
-             Player& player,
-             const std::string& message)
+void
+Game::queueTo(std::ostream& gameLog,
+              Player& player,
+              const std::string& message)
 {
-  if (player.send(message)) {
-    if (gameLog) {
-      (*gameLog) << "SERVER " << player.getName() << ": " << message
-                 << std::endl;
-    }
-    return true;
-  }
-  if (!errs.count(player.getPlayerID())) {
-    errs[player.getPlayerID()] = "I/O error";
-  }
-  return false;
+  gameLog << "SERVER " << player.getName() << ": " << message << '\n';
+  player.queue(message);
 }
 
 //-----------------------------------------------------------------------------
-bool
-Game::sendSonarDiscoveries(std::ostream& gameLog, Player& player) {
-  for (const auto& pair : spotted[player.getPlayerID()]) {
-    const unsigned subID = pair.first;
-    const unsigned distance = pair.second;
-    const std::string message = Msg('S') << turnNumber << subID << distance;
-    if (!sendTo((&gameLog), player, message)) {
-      return false;
-    }
-  }
-  return true;
-}
-
+// Send everything queued this turn with one write per player.  Players that
+// fail are reported in errs and left for the caller to remove.
 //-----------------------------------------------------------------------------
-bool
-Game::sendSprintDetections(std::ostream& gameLog, Player& player) {
-  for (const auto& pair : sprints[player.getPlayerID()]) {
-    const unsigned subID = pair.first;
-    const unsigned count = pair.second;
-    const std::string message = Msg('R') << turnNumber << subID << count;
-    if (!sendTo((&gameLog), player, message)) {
-      return false;
+void
+Game::flushAll() {
+  for (PlayerPtr& player : players) {
+    if (!player) {
+      throw Error("Null player in game.players table");
     }
-  }
-  return true;
-}
-
-//-----------------------------------------------------------------------------
-bool
-Game::sendDiscoveredObjects(std::ostream& gameLog, Player& player) {
-  for (const auto& pair : discovered[player.getPlayerID()]) {
-    const Coordinate coord(pair.first);
-    const unsigned size = pair.second;
-    const std::string message = Msg('O') << turnNumber << coord << size;
-    if (!sendTo((&gameLog), player, message)) {
-      return false;
+    if (!player->flush(broadcastHead, broadcastTail) &&
+        !errs.count(player->getPlayerID()))
+    {
+      errs[player->getPlayerID()] = "comm error"; // nothing more is sent
     }
   }
-  return true;
+  broadcastHead.clear();
+  broadcastTail.clear();
 }
 
 //-----------------------------------------------------------------------------
-bool
-Game::sendTorpedoHits(std::ostream& gameLog, Player& player) {
-  for (const auto& pair : torpedoHits[player.getPlayerID()]) {
-    const Coordinate coord(pair.first);
-    const unsigned damage = pair.second;
-    if (!sendTo((&gameLog), player,
-                Msg('T') << turnNumber << coord << damage))
-    {
-      return false;
+void
+Game::queueTurnEvents(std::ostream& gameLog, Player& player) {
+  const TurnEvents::EventRange range = events.forPlayer(player.getPlayerID());
+  for (const TurnEvents::Event* e = range.first; e != range.second; ++e) {
+    char type = 0;
+    switch (e->type) {
+    case TurnEvents::SonarHit:
+      type = 'S';
+      break;
+    case TurnEvents::SprintHeard:
+      type = 'R';
+      break;
+    case TurnEvents::Discovery:
+      type = 'O';
+      break;
+    case TurnEvents::TorpedoHit:
+      type = 'T';
+      break;
+    case TurnEvents::MineHit:
+      type = 'M';
+      break;
+    case TurnEvents::Detonation:
+      throw Error("Game::queueTurnEvents() detonation sent to one player");
     }
-  }
-  return true;
-}
 
-//-----------------------------------------------------------------------------
-bool
-Game::sendMineHits(std::ostream& gameLog, Player& player) {
-  for (const auto& pair : mineHits[player.getPlayerID()]) {
-    const Coordinate coord(pair.first);
-    const unsigned damage = pair.second;
-    if (!sendTo((&gameLog), player,
-                Msg('M') << turnNumber << coord << damage))
+    Msg msg(type);
+    msg << turnNumber;
+    if ((e->type == TurnEvents::SonarHit) ||
+        (e->type == TurnEvents::SprintHeard))
     {
-      return false;
+      msg << e->subID;
+    } else {
+      msg << e->coord;
     }
+    msg << e->amount;
+    queueTo(gameLog, player, msg);
   }
-  return true;
 }
 
 //-----------------------------------------------------------------------------
-bool
-Game::sendSubInfo(std::ostream& gameLog, Player& player) {
+void
+Game::queueSubInfo(std::ostream& gameLog, Player& player) {
   for (unsigned subID = 0; subID < player.getSubmarineCount(); ++subID) {
     const Submarine& sub = player.getSubmarine(subID);
     Msg msg('I');
@@ -657,18 +637,14 @@ Game::sendSubInfo(std::ostream& gameLog, Player& player) {
     if (sub.isDead()) {
       msg << "dead=1";
     }
-    if (!sendTo((&gameLog), player, msg)) {
-      return false;
-    }
+    queueTo(gameLog, player, msg);
   }
-  return true;
 }
 
 //-----------------------------------------------------------------------------
-bool
-Game::sendScore(std::ostream& gameLog, Player& player) {
-  return sendTo((&gameLog), player,
-                Msg('H') << turnNumber << player.getScore());
+void
+Game::queueScore(std::ostream& gameLog, Player& player) {
+  queueTo(gameLog, player, Msg('H') << turnNumber << player.getScore());
 }
 
 //-----------------------------------------------------------------------------
@@ -682,12 +658,7 @@ Game::executeTurn(std::ostream& gameLog) {
 
   torpedoShots.clear();
   nuclearDetonations.clear();
-  detonations.clear();
-  spotted.clear();
-  sprints.clear();
-  discovered.clear();
-  torpedoHits.clear();
-  mineHits.clear();
+  events.clear();
   errs.clear();
 
   exec(gameLog, Command::Sleep);
@@ -700,43 +671,32 @@ Game::executeTurn(std::ostream& gameLog) {
   executeRepairs();
   exec(gameLog, Command::Ping);
 
-  commands.clear();
+  clearCommands();
 
-  for (const auto& pair : detonations) {
-    sendToAll(gameLog, Msg('D') << turnNumber << pair.first << pair.second);
+  events.sort();
+  const TurnEvents::EventRange blasts =
+      events.forPlayer(TurnEvents::ALL_PLAYERS);
+  for (const TurnEvents::Event* e = blasts.first; e != blasts.second; ++e) {
+    queueToAll(gameLog, broadcastHead,
+               Msg('D') << turnNumber << e->coord << e->amount);
   }
 
-  for (auto it = players.begin(); it != players.end(); ) {
-    PlayerPtr& player = it->second;
+  for (PlayerPtr& player : players) {
     if (!player) {
-      throw Error("Null player in game.players map");
-    }
-    if (!sendSonarDiscoveries(gameLog, (*player)) ||
-        !sendSprintDetections(gameLog, (*player)) ||
-        !sendDiscoveredObjects(gameLog, (*player)) ||
-        !sendTorpedoHits(gameLog, (*player)) ||
-        !sendMineHits(gameLog, (*player)) ||
-        !sendSubInfo(gameLog, (*player)) ||
-        !sendScore(gameLog, (*player)))
-    {
-      for (unsigned subID = 0; subID < player->getSubmarineCount(); ++subID) {
-        SubmarinePtr sub = player->getSubmarinePtr(subID);
-        if (sub->getLocation()) {
-          gameMap.removeObject(sub->getLocation(), sub);
-        }
-      }
-      it = players.erase(it);
-    } else {
-      it++;
+      throw Error("Null player in game.players table");
     }
+    queueTurnEvents(gameLog, (*player));
+    queueSubInfo(gameLog, (*player));
+    queueScore(gameLog, (*player));
   }
 
+  countPendingCommands();
+
   unsigned alive = 0;
   PlayerPtr lastPlayer;
-  for (auto it = players.begin(); it != players.end(); ++it) {
-    PlayerPtr& player = it->second;
+  for (PlayerPtr& player : players) {
     if (!player) {
-      throw Error("Null player in game.players map");
+      throw Error("Null player in game.players table");
     }
     for (unsigned subID = 0; subID < player->getSubmarineCount(); ++subID) {
       SubmarinePtr sub = player->getSubmarinePtr(subID);
@@ -744,7 +704,7 @@ Game::executeTurn(std::ostream& gameLog) {
         lastPlayer = player;
         alive++;
       } else if (sub->getLocation()) {
-        gameMap.removeObject(sub->getLocation(), sub);
+        gameMap.removeObject(sub->getLocation(), sub.get());
       }
     }
   }
@@ -757,69 +717,271 @@ Game::executeTurn(std::ostream& gameLog) {
     }
     finish();
   } else {
-    sendToAll(gameLog, Msg('B') << ++turnNumber);
+    queueToAll(gameLog, broadcastTail, Msg('B') << ++turnNumber);
   }
 
+  gameLog.flush(); // on record before any player hears of it
+  flushAll();
   return errs;
 }
 
 //-----------------------------------------------------------------------------
-void Game::exec(std::ostream& gameLog, const Command::CommandType type) {
-  for (const UniqueCommand& command : commands) {
-    if (command->getType() == type) {
-      PlayerPtr player = getPlayer(static_cast<int>(command->getPlayerID()));
-      SubmarinePtr sub = player->getSubmarinePtr(command->getSubID());
+// Order every active sub that has no command this turn to sleep without
+// charging anything, used when the turn deadline passes.  Idle reactors
+// take damage, so missing a deadline is never free.
+//-----------------------------------------------------------------------------
+unsigned
+Game::sleepPendingSubs() {
+  if (!started || isFinished()) {
+    return 0;
+  }
 
-      if (sub->isDead()) {
-        continue;
-      } else if (!sub->isActive()) {
-        throw Error("Game::exec() command queued for surfaced submarine!");
-      } else if (sub->hasDetonated()) {
-        throw Error("Game::exec() nuclear detonations out of sync!");
+  unsigned count = 0;
+  std::string err;
+  const unsigned subsPerPlayer = config.getSubsPerPlayer();
+  for (PlayerPtr& player : players) {
+    const unsigned first = (playerSlots[player->handle()] * subsPerPlayer);
+    for (unsigned subID = 0; subID < player->getSubmarineCount(); ++subID) {
+      if (player->getSubmarine(subID).isActive() && !subOrders[first + subID]) {
+        const SleepCommand command(player->getPlayerID(), turnNumber, subID,
+                                   Submarine::None, Submarine::None);
+        if (!addCommand(player->handle(), command, err)) {
+          throw Error(Msg() << "Game::sleepPendingSubs() " << err);
+        }
+        count++;
       }
+    }
+  }
+  return count;
+}
+
+//-----------------------------------------------------------------------------
+void
+Game::saveState(GameState& state) const {
+  if (!started) {
+    throw Error("Game::saveState() game has not been started");
+  }
+
+  const unsigned subsPerPlayer = config.getSubsPerPlayer();
+  state.reset(players.size(), subsPerPlayer, gameMap.getMineCount(),
+              gameMap.getWidth(), gameMap.getHeight());
+
+  GameState::Header& head = state.header();
+  head.rng = rng;
+  head.aborted = aborted;
+  head.finished = finished;
+  head.turnNumber = turnNumber;
+
+  GameState::PlayerInfo* playerInfo = state.players();
+  GameState::SubInfo* subInfo = state.subs();
+  for (unsigned slot = 0; slot < players.size(); ++slot) {
+    const Player& player = (*players[slot]);
+    ASSERT(player.getSubmarineCount() == subsPerPlayer);
+    playerInfo[slot] = GameState::PlayerInfo {
+      player.getPlayerID(),
+      player.getScore()
+    };
+    for (unsigned subID = 0; subID < subsPerPlayer; ++subID) {
+      subInfo[(slot * subsPerPlayer) + subID] = GameState::SubInfo {
+        player.getSubmarine(subID).getState(),
+        ~0U
+      };
+    }
+  }
 
-      bool ok = false;
-      switch (type) {
-      case Command::Invalid:
-        throw Error("Invalid command in command queue");
-      case Command::Sleep:
-        ok = exec(sub, static_cast<const SleepCommand&>(*command));
-        break;
-      case Command::Move:
-        ok = exec(sub, static_cast<const MoveCommand&>(*command));
-        break;
-      case Command::Sprint:
-        ok = exec(sub, static_cast<const SprintCommand&>(*command));
-        break;
-      case Command::DeployMine:
-        ok = exec(sub, static_cast<const MineCommand&>(*command));
-        break;
-      case Command::FireTorpedo:
-        ok = exec(sub, static_cast<const FireCommand&>(*command));
-        break;
-      case Command::Surface:
-        ok = exec(sub, static_cast<const SurfaceCommand&>(*command));
-        break;
-      case Command::Ping:
-        ok = exec(sub, static_cast<const PingCommand&>(*command));
-        break;
+  // number the subs and mines in the order they sit in their squares
+  GameState::MineInfo* mineInfo = state.mines();
+  uint8_t* grid = state.grid();
+  unsigned order = 0;
+  unsigned mineCount = 0;
+  for (unsigned i = 0; i < gameMap.getSize(); ++i) {
+    const Square& square = gameMap.getSquare(i);
+    uint8_t flags = 0;
+    if (square.isBlocked()) {
+      flags = GameState::Blocked;
+    } else if (square.isOccupied()) {
+      for (const Object* object : square) {
+        if (object->isMine()) {
+          flags |= GameState::HasMines;
+          mineInfo[mineCount++] = GameState::MineInfo {
+            static_cast<uint16_t>(square.getX()),
+            static_cast<uint16_t>(square.getY()),
+            object->getPlayerID(),
+            order++,
+            static_cast<char>(object->getMapChar())
+          };
+        } else if (object->isSubmarine()) {
+          flags |= GameState::HasSubs;
+          const unsigned slot = playerSlots[object->getPlayerID()];
+          subInfo[(slot * subsPerPlayer) + object->getObjectID()].mapOrder =
+              order++;
+        }
       }
+    }
+    grid[i] = flags;
+  }
+  ASSERT(mineCount == state.getMineCount());
+}
 
-      if (ok) {
-        gameLog << "PLAYER " << player->getName() << ": "
-                << command->toString() << std::endl;
+//-----------------------------------------------------------------------------
+// Put the game back the way it was when the state was saved.  Commands
+// queued for the current turn are dropped.
+//-----------------------------------------------------------------------------
+void
+Game::restoreState(const GameState& state) {
+  const unsigned subsPerPlayer = config.getSubsPerPlayer();
+  if (!started) {
+    throw Error("Game::restoreState() game has not been started");
+  } else if (state.isEmpty() ||
+             (state.getPlayerCount() != players.size()) ||
+             (state.getSubsPerPlayer() != subsPerPlayer) ||
+             (state.getWidth() != gameMap.getWidth()) ||
+             (state.getHeight() != gameMap.getHeight()))
+  {
+    throw Error("Game::restoreState() state is from a different game");
+  }
+  for (unsigned slot = 0; slot < players.size(); ++slot) {
+    if (state.getPlayer(slot).playerID != players[slot]->getPlayerID()) {
+      throw Error("Game::restoreState() state has different players");
+    }
+  }
+
+  for (PlayerPtr& player : players) {
+    for (unsigned subID = 0; subID < subsPerPlayer; ++subID) {
+      Submarine& sub = player->getSubmarine(subID);
+      if (sub.getLocation()) {
+        gameMap.removeObject(sub.getLocation(), &sub);
       }
+    }
+  }
+  gameMap.clearMines();
 
-      if (sub->hasDetonated()) {
-        nuclearDetonations.push_back(sub);
+  unsigned placed = state.getMineCount();
+  for (unsigned slot = 0; slot < players.size(); ++slot) {
+    players[slot]->setScore(state.getPlayer(slot).score);
+    for (unsigned subID = 0; subID < subsPerPlayer; ++subID) {
+      const GameState::SubInfo& info = state.getSub(slot, subID);
+      players[slot]->getSubmarine(subID).setState(info.state);
+      placed += (info.mapOrder != ~0U);
+    }
+  }
+
+  // put subs and mines back in their original order, the order within a
+  // square decides whose mine goes off and the order of sonar reports
+  placements.assign(placed, nullptr);
+  for (unsigned slot = 0; slot < players.size(); ++slot) {
+    for (unsigned subID = 0; subID < subsPerPlayer; ++subID) {
+      const unsigned order = state.getSub(slot, subID).mapOrder;
+      if (order != ~0U) {
+        ASSERT(order < placed);
+        placements[order] = &players[slot]->getSubmarine(subID);
       }
     }
   }
+  unsigned mineIdx = 0;
+  for (Submarine* sub : placements) {
+    if (sub) {
+      gameMap.addObject(sub->getLocation(), sub);
+    } else {
+      const GameState::MineInfo& mine = state.getMine(mineIdx++);
+      gameMap.addMine(Coordinate(mine.x, mine.y), mine.playerID,
+                      mine.mapChar);
+    }
+  }
+
+  const GameState::Header& head = state.header();
+  rng = head.rng;
+  aborted = head.aborted;
+  finished = head.finished;
+  turnNumber = head.turnNumber;
+
+  torpedoShots.clear();
+  nuclearDetonations.clear();
+  events.clear();
+  errs.clear();
+  broadcastHead.clear();
+  broadcastTail.clear();
+  clearCommands();
+  countPendingCommands();
+}
+
+//-----------------------------------------------------------------------------
+void
+Game::clearCommands() {
+  for (CommandQueue& queue : commandQueues) {
+    queue.clear();
+  }
+  commandCount = 0;
+}
+
+//-----------------------------------------------------------------------------
+void
+Game::countPendingCommands() {
+  const unsigned subsPerPlayer = config.getSubsPerPlayer();
+  subOrders.assign((players.size() * subsPerPlayer), false);
+  pendingCommands = 0;
+  for (const PlayerPtr& player : players) {
+    for (unsigned subID = 0; subID < player->getSubmarineCount(); ++subID) {
+      pendingCommands += player->getSubmarine(subID).isActive();
+    }
+  }
+}
+
+//-----------------------------------------------------------------------------
+void Game::exec(std::ostream& gameLog, const Command::CommandType type) {
+  for (QueuedCommand& queued : commandQueues[type]) {
+    PlayerPtr& player = queued.player;
+    SubmarinePtr& sub = queued.sub;
+    const Command& command = queued.command;
+
+    if (sub->isDead()) {
+      continue;
+    } else if (!sub->isActive()) {
+      throw Error("Game::exec() command queued for surfaced submarine!");
+    } else if (sub->hasDetonated()) {
+      throw Error("Game::exec() nuclear detonations out of sync!");
+    }
+
+    switch (type) {
+    case Command::Invalid:
+      throw Error("Invalid command in command queue");
+    case Command::Sleep:
+      execSleep(player, sub, command);
+      break;
+    case Command::Move:
+      execMove(player, sub, command);
+      break;
+    case Command::Sprint:
+      execSprint(player, sub, command);
+      break;
+    case Command::DeployMine:
+      execMine(player, sub, command);
+      break;
+    case Command::FireTorpedo:
+      execFire(player, sub, command);
+      break;
+    case Command::Surface:
+      execSurface(player, sub, command);
+      break;
+    case Command::Ping:
+      execPing(player, sub, command);
+      break;
+    }
+
+    // failed commands are logged too, they can still change the sub
+    // (a sleep may charge its first item) and replays must repeat that
+    gameLog << "PLAYER " << player->getName() << ": "
+            << command.toString() << '\n';
+
+    if (sub->hasDetonated()) {
+      nuclearDetonations.push_back(sub);
+    }
+  }
 }
 
 //-----------------------------------------------------------------------------
 bool
-Game::exec(SubmarinePtr& sub, const SleepCommand& command) {
+Game::execSleep(PlayerPtr&, SubmarinePtr& sub, const Command& command) {
   if (sub->charge(command.getEquip1()) && sub->charge(command.getEquip2())) {
     return true;
   }
@@ -829,14 +991,14 @@ Game::exec(SubmarinePtr& sub, const SleepCommand& command) {
 
 //-----------------------------------------------------------------------------
 bool
-Game::exec(SubmarinePtr& sub, const MoveCommand& command) {
+Game::execMove(PlayerPtr&, SubmarinePtr& sub, const Command& command) {
   const Coordinate from = sub->getLocation();
   const Coordinate to = (from + command.getDirection());
 
   if (gameMap.contains(to) && !gameMap.getSquare(to).isBlocked() &&
       sub->charge(command.getEquip()))
   {
-    gameMap.moveObject(from, to, sub);
+    gameMap.moveObject(from, to, sub.get());
     detonateMines(gameMap.getSquare(to));
     return true;
   }
@@ -847,18 +1009,19 @@ Game::exec(SubmarinePtr& sub, const MoveCommand& command) {
 
 //-----------------------------------------------------------------------------
 bool
-Game::exec(SubmarinePtr& sub, const SprintCommand& command) {
-  const Coordinate from = sub->getLocation();
-  Coordinate to(from + command.getDirection());
+Game::execSprint(PlayerPtr&, SubmarinePtr& sub, const Command& command) {
+  Coordinate to(sub->getLocation());
 
   if (sub->sprint(command.getDistance())) {
-    auto canHear = gameMap.squaresInRangeOf(sub->getLocation(), 4);
+    heardSubs.clear();
+    listenForSubs(sub->getLocation(), 4, sub->getPlayerID());
     unsigned dist = 0;
     for (unsigned i = 0; i < command.getDistance(); ++i) {
-      to.shift(command.getDirection());
-      if (gameMap.contains(to) && !gameMap.getSquare(to).isBlocked()) {
+      const Coordinate next(to + command.getDirection());
+      if (gameMap.contains(next) && !gameMap.getSquare(next).isBlocked()) {
         dist++;
-        gameMap.moveObject(from, to, sub);
+        gameMap.moveObject(to, next, sub.get());
+        to = next;
         if (detonateMines(gameMap.getSquare(to))) {
           break;
         }
@@ -868,23 +1031,13 @@ Game::exec(SubmarinePtr& sub, const SprintCommand& command) {
       }
     }
     if (dist) {
-      auto tmp = gameMap.squaresInRangeOf(to, 4);
-      canHear.insert(tmp.begin(), tmp.end());
-      std::map<unsigned, std::set<unsigned>> enemySubs;
-      for (auto it = canHear.begin(); it != canHear.end(); ++it) {
-        const Square& square = gameMap.getSquare(it->first);
-        for (const ObjectPtr& obj : square) {
-          Submarine* heard = dynamic_cast<Submarine*>(obj.get());
-          if (heard && (heard->getPlayerID() != sub->getPlayerID())) {
-            enemySubs[heard->getPlayerID()].insert(heard->getObjectID());
-          }
-        }
-      }
-      for (auto it = enemySubs.begin(); it != enemySubs.end(); ++it) {
-        const unsigned playerID = it->first;
-        for (unsigned subID : it->second) {
-          sprints[playerID][subID] += 1;
-        }
+      // subs heard at both ends of the sprint only hear it once
+      listenForSubs(to, 4, sub->getPlayerID());
+      std::sort(heardSubs.begin(), heardSubs.end());
+      heardSubs.erase(std::unique(heardSubs.begin(), heardSubs.end()),
+                      heardSubs.end());
+      for (const auto& pair : heardSubs) {
+        events.addSprintHeard(pair.first, pair.second);
       }
     }
   }
@@ -894,19 +1047,12 @@ Game::exec(SubmarinePtr& sub, const SprintCommand& command) {
 
 //-----------------------------------------------------------------------------
 bool
-Game::exec(SubmarinePtr& sub, const MineCommand& command) {
+Game::execMine(PlayerPtr& player, SubmarinePtr& sub, const Command& command) {
   const Coordinate to = (sub->getLocation() + command.getDirection());
   if (gameMap.contains(to) && !gameMap.getSquare(to).isBlocked()) {
     if (sub->mine()) {
-      const int playerHandle = static_cast<int>(sub->getPlayerID());
-      PlayerPtr player = getPlayer(playerHandle);
-      if (!player) {
-        throw Error(Msg() << "No player for handle " << playerHandle);
-      }
-
       Square& dest = gameMap.getSquare(to);
-      gameMap.addObject(to, std::make_shared<Mine>(
-                          sub->getPlayerID(), tolower(player->getMapChar())));
+      gameMap.addMine(to, sub->getPlayerID(), tolower(player->getMapChar()));
 
       if (dest.isOccupied()) {
         detonateMines(gameMap.getSquare(to));
@@ -921,19 +1067,15 @@ Game::exec(SubmarinePtr& sub, const MineCommand& command) {
 
 //-----------------------------------------------------------------------------
 bool
-Game::exec(SubmarinePtr& sub, const FireCommand& command) {
+Game::execFire(PlayerPtr& player, SubmarinePtr& sub, const Command& command) {
   const Coordinate to = command.getDestination();
   if (gameMap.contains(to) && !gameMap.getSquare(to).isBlocked()) {
-    const auto dests = gameMap.squaresInRangeOf(sub->getLocation(),
-                                                sub->getTorpedoRange());
-    const auto it = dests.find(to);
-    const unsigned distance = (it == dests.end()) ? ~0U : it->second;
+    const GameMap::Range dests = gameMap.squaresInRangeOf(
+          sub->getLocation(), sub->getTorpedoRange());
+    const unsigned distance = dests.distanceTo(to);
     if (sub->fire(distance)) {
-      PlayerPtr player = getPlayer(static_cast<int>(sub->getPlayerID()));
-      if (player) {
-        detonationFrom(player, to, TORPEDO, gameMap.getSquare(to));
-        torpedoShots.push_back(getTorpedoShot(dests, sub->getLocation(), to, 1));
-      }
+      detonationFrom(player, to, TORPEDO, gameMap.getSquare(to));
+      torpedoShots.push_back(getTorpedoShot(dests, sub->getLocation(), to, 1));
     }
     return true;
   }
@@ -944,7 +1086,7 @@ Game::exec(SubmarinePtr& sub, const FireCommand& command) {
 
 //-----------------------------------------------------------------------------
 bool
-Game::exec(SubmarinePtr& sub, const SurfaceCommand&) {
+Game::execSurface(PlayerPtr&, SubmarinePtr& sub, const Command&) {
   if (sub->surface()) {
     return true;
   }
@@ -955,47 +1097,86 @@ Game::exec(SubmarinePtr& sub, const SurfaceCommand&) {
 
 //-----------------------------------------------------------------------------
 bool
-Game::exec(SubmarinePtr& sub, const PingCommand&) {
+Game::execPing(PlayerPtr&, SubmarinePtr& sub, const Command&) {
   const unsigned range = sub->ping();
   if (range) {
-    auto dests = gameMap.squaresInRangeOf(sub->getLocation(), range);
-    for (auto it = dests.begin(); it != dests.end(); ++it) {
-      const unsigned distance = it->second;
+    const GameMap::Range dests = gameMap.squaresInRangeOf(
+          sub->getLocation(), range);
+    for (const unsigned idx : dests) {
+      const unsigned distance = dests.distanceAt(idx);
+      const Square& square = gameMap.getSquare(idx);
       if (distance > 0) {
-        const Square& square = gameMap.getSquare(it->first);
         if (square.isOccupied()) {
-          discovered[sub->getPlayerID()].push_back(
-                std::make_pair(it->first, square.getSizeOfObjects()));
-
-          for (const ObjectPtr& obj : square) {
-            Submarine* found = dynamic_cast<Submarine*>(obj.get());
-            if (found && (found->getPlayerID() != sub->getPlayerID())) {
-              spotted[found->getPlayerID()].push_back(
-                    std::make_pair(found->getObjectID(), distance));
+          const Coordinate coord(square);
+          events.addDiscovery(sub->getPlayerID(), coord,
+                              square.getSizeOfObjects());
+
+          if (!square.hasSubmarines()) {
+            continue;
+          }
+          for (const Object* obj : square) {
+            if (obj->isSubmarine() &&
+                (obj->getPlayerID() != sub->getPlayerID()))
+            {
+              events.addSonarHit(obj->getPlayerID(), obj->getObjectID(),
+                                 distance);
             }
           }
         }
       } else {
-        ASSERT(it->first == sub->getLocation());
+        ASSERT(square == sub->getLocation());
       }
     }
   }
   return true;
 }
 
+//-----------------------------------------------------------------------------
+void
+Game::listenForSubs(const Coordinate& coord,
+                    const unsigned range,
+                    const unsigned playerID)
+{
+  const GameMap::Range canHear = gameMap.squaresInRangeOf(coord, range);
+  for (const unsigned idx : canHear) {
+    const Square& square = gameMap.getSquare(idx);
+    if (!square.hasSubmarines()) {
+      continue;
+    }
+    for (const Object* obj : square) {
+      if (obj->isSubmarine() && (obj->getPlayerID() != playerID)) {
+        heardSubs.push_back(
+            std::make_pair(obj->getPlayerID(), obj->getObjectID()));
+      }
+    }
+  }
+}
+
 //-----------------------------------------------------------------------------
 void
 Game::executeNuclearDetonations() {
-  for (SubmarinePtr sub : nuclearDetonations) {
-    detonations.push_back(std::make_pair(sub->getLocation(), 2U));
+  // inflictDamageFrom() may erase subs that have not detonated yet
+  for (unsigned i = 0; i < nuclearDetonations.size(); ++i) {
+    SubmarinePtr sub = nuclearDetonations[i];
+    events.addDetonation(sub->getLocation(), 2);
     Square& square = gameMap.getSquare(sub->getLocation());
+    gameMap.clearMines(square);
     for (auto it = square.begin(); it != square.end(); ) {
-      Object* object = it->get();
+      Object* object = (*it);
       if (!object->isPermanent()) {
-        Submarine* sub = dynamic_cast<Submarine*>(object);
-        if (sub) {
-          sub->kill();
+        if (object->isSubmarine()) {
+          Submarine* victim = static_cast<Submarine*>(object);
+          victim->kill();
+          // a sub destroyed by the blast no longer detonates on its own
+          for (unsigned n = (i + 1); n < nuclearDetonations.size(); ) {
+            if (nuclearDetonations[n].get() == victim) {
+              nuclearDetonations.erase(nuclearDetonations.begin() + n);
+            } else {
+              n++;
+            }
+          }
         }
+        object->setLocation(Coordinate());
         it = square.erase(it);
       } else {
         it++;
@@ -1009,9 +1190,12 @@ Game::executeNuclearDetonations() {
 
     for (const Coordinate& coord : coords) {
       Square& adjacentSquare = gameMap.getSquare(coord);
-      for (ObjectPtr& object : adjacentSquare) {
-        Submarine* sub = dynamic_cast<Submarine*>(object.get());
-        if (sub) {
+      if (!adjacentSquare.hasSubmarines()) {
+        continue;
+      }
+      for (Object* object : adjacentSquare) {
+        if (object->isSubmarine()) {
+          Submarine* sub = static_cast<Submarine*>(object);
           switch (blastDistance(square, adjacentSquare)) {
           case 1:
             sub->takeHits(2);
@@ -1030,8 +1214,7 @@ Game::executeNuclearDetonations() {
 //-----------------------------------------------------------------------------
 void
 Game::executeRepairs() {
-  for (auto it = players.begin(); it != players.end(); ++it) {
-    PlayerPtr& player = it->second;
+  for (PlayerPtr& player : players) {
     for (unsigned subID = 0; subID < player->getSubmarineCount(); ++subID) {
       player->getSubmarine(subID).repair();
     }
@@ -1041,29 +1224,22 @@ Game::executeRepairs() {
 //-----------------------------------------------------------------------------
 bool
 Game::detonateMines(Square& square) {
-  PlayerPtr player;
-  Coordinate coord;
-
-  for (auto it = square.begin(); it != square.end(); ) {
-    Mine* mine = dynamic_cast<Mine*>(it->get());
-    if (mine) {
-      // only detonate first mine (it destroys all other mines on this square)
-      if (!player) {
-        player = getPlayer(static_cast<int>(mine->getPlayerID()));
-        coord.set(square);
-      }
-      it = square.erase(it);
-    } else {
-      it++;
-    }
+  if (!square.hasMines()) {
+    return false;
   }
 
-  if (coord) {
-    detonationFrom(player, square, MINE, gameMap.getSquare(coord));
-    return true;
+  // only detonate first mine (it destroys all other mines on this square)
+  PlayerPtr player;
+  for (const Object* object : square) {
+    if (object->isMine()) {
+      player = getPlayer(static_cast<int>(object->getPlayerID()));
+      break;
+    }
   }
 
-  return false;
+  gameMap.clearMines(square);
+  detonationFrom(player, square, MINE, square);
+  return true;
 }
 
 //-----------------------------------------------------------------------------
@@ -1071,17 +1247,10 @@ void
 Game::detonationFrom(PlayerPtr& player, const Coordinate& sourceSquare,
                      const unsigned type, Square& damagedSquare)
 {
-  detonations.push_back(std::make_pair(Coordinate(damagedSquare), 1U));
+  events.addDetonation(damagedSquare, 1);
 
   // destroy mines on this square
-  for (auto it = damagedSquare.begin(); it != damagedSquare.end(); ) {
-    Mine* mine = dynamic_cast<Mine*>(it->get());
-    if (mine) {
-      it = damagedSquare.erase(it);
-    } else {
-      it++;
-    }
-  }
+  gameMap.clearMines(damagedSquare);
 
   // direct hit on submarines in this square
   inflictDamageFrom(player, sourceSquare, type, damagedSquare, 2);
@@ -1102,9 +1271,13 @@ Game::inflictDamageFrom(PlayerPtr& player, const Coordinate& sourceSquare,
                         const unsigned type, Square& damagedSquare,
                         const unsigned damage)
 {
-  for (ObjectPtr& object : damagedSquare) {
-    Submarine* sub = dynamic_cast<Submarine*>(object.get());
-    if (sub) {
+  if (!damagedSquare.hasSubmarines()) {
+    return;
+  }
+
+  for (Object* object : damagedSquare) {
+    if (object->isSubmarine()) {
+      Submarine* sub = static_cast<Submarine*>(object);
       sub->takeHits(damage);
       if (sub->isDead()) {
         for (auto it = nuclearDetonations.begin();
@@ -1121,10 +1294,10 @@ Game::inflictDamageFrom(PlayerPtr& player, const Coordinate& sourceSquare,
         player->incScore(damage);
         switch (type) {
         case TORPEDO:
-          torpedoHits[player->getPlayerID()][sourceSquare] += damage;
+          events.addTorpedoHit(player->getPlayerID(), sourceSquare, damage);
           break;
         case MINE:
-          mineHits[player->getPlayerID()][sourceSquare] += damage;
+          events.addMineHit(player->getPlayerID(), sourceSquare, damage);
           break;
         }
       }
@@ -1148,9 +1321,9 @@ Game::blastDistance(const Coordinate& from, const Coordinate& to) const {
 
 //-----------------------------------------------------------------------------
 GameMap::TorpedoShot
-Game::getTorpedoShot(const std::map<Coordinate, unsigned>& dist,
+Game::getTorpedoShot(const GameMap::Range& dist,
                      const Coordinate& from, const Coordinate& to,
-                     const unsigned blastRadius) const
+                     const unsigned blastRadius)
 {
   GameMap::TorpedoShot shot;
   shot.first.push_back(to);
@@ -1170,15 +1343,16 @@ Game::getTorpedoShot(const std::map<Coordinate, unsigned>& dist,
 
   while (true) {
     Coordinate dest;
-    std::random_shuffle(dirs.begin(), dirs.end());
+    rng.shuffle(dirs.begin(), dirs.end());
     for (Direction dir : dirs) {
       Coordinate coord = (src + dir);
       if (coord == from) {
         std::reverse(shot.first.begin(), shot.first.end());
         return std::move(shot);
       }
-      if (dist.count(coord) && (dist.at(coord) < distance)) {
-        distance = dist.at(coord);
+      const unsigned coordDistance = dist.distanceTo(coord);
+      if (coordDistance < distance) {
+        distance = coordDistance;
         dest = coord;
       }
     }
@@ -1190,7 +1364,7 @@ Game::getTorpedoShot(const std::map<Coordinate, unsigned>& dist,
 
 //-----------------------------------------------------------------------------
 std::vector<Coordinate>
-Game::getBlastCoordinates(const Coordinate& src, const unsigned range) const {
+Game::getBlastCoordinates(const Coordinate& src, const unsigned range) {
   const unsigned minX = (src.getX() > range) ? (src.getX() - range) : 1;
   const unsigned maxX = ((src.getX() + range) < gameMap.getWidth())
       ? (src.getX() + range) : gameMap.getWidth();
@@ -1209,7 +1383,7 @@ Game::getBlastCoordinates(const Coordinate& src, const unsigned range) const {
     }
   }
 
-  std::random_shuffle(coords.begin(), coords.end());
+  rng.shuffle(coords.begin(), coords.end());
   return std::move(coords);
 }
 
@@ -6,6 +6,7 @@
 
 #include "utils/Platform.h"
 #include "utils/Input.h"
+#include "utils/Random.h"
 #include "utils/Timer.h"
 #include "db/Database.h"
 #include "commands/Command.h"
@@ -18,7 +19,9 @@
 #include "commands/SurfaceCommand.h"
 #include "GameConfig.h"
 #include "GameMap.h"
+#include "GameState.h"
 #include "Player.h"
+#include "TurnEvents.h"
 #include <ostream>
 
 namespace subsim
@@ -28,23 +31,36 @@ namespace subsim
 class Game {
 //-----------------------------------------------------------------------------
 public: // typedefs
-  typedef std::list<GameMap::TorpedoShot> TorpedoShots;
+  typedef std::vector<GameMap::TorpedoShot> TorpedoShots;
+
+  struct QueuedCommand {
+    PlayerPtr player;
+    SubmarinePtr sub;
+    Command command;
+  };
+
+  typedef std::vector<QueuedCommand> CommandQueue;
 
 //-----------------------------------------------------------------------------
 private: // variables
   std::string title;
   GameConfig config;
   GameMap gameMap;
+  Random rng;
   TorpedoShots torpedoShots;
-  std::map<int, PlayerPtr> players;
-  std::list<UniqueCommand> commands;
-  std::list<SubmarinePtr> nuclearDetonations;
-  std::list<std::pair<Coordinate, unsigned>> detonations;
-  std::map<unsigned, std::list<std::pair<unsigned, unsigned>>> spotted;
-  std::map<unsigned, std::map<unsigned, unsigned>> sprints;
-  std::map<unsigned, std::list<std::pair<Coordinate, unsigned>>> discovered;
-  std::map<unsigned, std::map<Coordinate, unsigned>> torpedoHits;
-  std::map<unsigned, std::map<Coordinate, unsigned>> mineHits;
+  std::vector<PlayerPtr> players;      // in join order
+  std::vector<unsigned> playerSlots;  // player handle -> index into players
+  CommandQueue commandQueues[Command::Ping + 1]; // indexed by CommandType,
+                                                 // reserved at game start
+  unsigned commandCount = 0;
+  std::vector<bool> subOrders; // slot * subsPerPlayer + subID -> has command
+  unsigned pendingCommands = 0; // active subs with no command this turn
+  std::vector<SubmarinePtr> nuclearDetonations;
+  std::vector<std::pair<unsigned, unsigned>> heardSubs; // sprint work buffer
+  std::vector<Submarine*> placements; // restoreState() work buffer
+  TurnEvents events;
+  std::string broadcastHead; // D messages, sent before each player's queue
+  std::string broadcastTail; // B message, sent after each player's queue
   std::map<unsigned, unsigned> points;
   std::map<unsigned, std::string> errs;
   Timestamp started = 0;
@@ -66,6 +82,8 @@ public: // inline methods
   const GameConfig& getConfig() const noexcept { return config; }
   const GameMap& getMap() const noexcept { return gameMap; }
   const TorpedoShots& shotsFired() const noexcept { return torpedoShots; }
+  const std::vector<PlayerPtr>& getPlayers() const noexcept { return players; }
+  uint64_t getSeed() const noexcept { return rng.getSeed(); }
 
   bool isAborted() const noexcept { return aborted; }
   bool isFinished() const noexcept { return (aborted || finished); }
@@ -74,7 +92,10 @@ public: // inline methods
   unsigned getPlayerCount() const noexcept { return players.size(); }
   unsigned getTurnNumber() const noexcept { return turnNumber; }
 
-  void clearPlayers() { players.clear(); }
+  void clearPlayers() {
+    players.clear();
+    playerSlots.clear();
+  }
 
   Milliseconds elapsedTime() const noexcept {
     return finished ? (finished - started) : aborted ? (aborted - started) : 0;
@@ -87,46 +108,59 @@ public: // methods
   bool addCommand(const int playerHandle,
                   Input&,
                   std::string& err);
+  bool addCommand(const int playerHandle,
+                  const Command&,
+                  std::string& err);
 
   PlayerPtr getPlayer(const int playerHandle) const;
   PlayerPtr getPlayer(const std::string playerName) const;
 
-  std::vector<PlayerPtr> getPlayers() const;
   std::vector<PlayerPtr> playersFromAddress(const std::string address) const;
 
   std::map<unsigned, std::string> start(std::ostream& gameLog);
   std::map<unsigned, std::string> executeTurn(std::ostream& gameLog);
+  unsigned sleepPendingSubs();
+  void saveState(GameState&) const;
+  void restoreState(const GameState&);
 
-  void reset(const GameConfig& gameConfig, const std::string& gameTitle);
+  void reset(const GameConfig& gameConfig,
+             const std::string& gameTitle,
+             const uint64_t seed);
   void printSummary(Coordinate&) const;
   void abort() noexcept;
   void finish() noexcept;
 
   std::string addPlayer(PlayerPtr, Input&);
+  std::string addPlayer(PlayerPtr, const std::vector<Coordinate>&);
   void removePlayer(const int playerHandle);
   void saveResults(Database&) const;
 
 //-----------------------------------------------------------------------------
 private: // methods
-  void sendToAll(std::ostream& gameLog, const std::string& message);
-  bool sendTo(std::ostream* gameLog, Player&, const std::string& message);
-
-  bool sendSonarDiscoveries(std::ostream& gameLog, Player&);
-  bool sendSprintDetections(std::ostream& gameLog, Player&);
-  bool sendDiscoveredObjects(std::ostream& gameLog, Player&);
-  bool sendTorpedoHits(std::ostream& gameLog, Player&);
-  bool sendMineHits(std::ostream& gameLog, Player&);
-  bool sendSubInfo(std::ostream& gameLog, Player&);
-  bool sendScore(std::ostream& gameLog, Player&);
-
+  void queueToAll(std::ostream& gameLog,
+                  std::string& buffer,
+                  const std::string& message);
+  void queueTo(std::ostream& gameLog, Player&, const std::string& message);
+  void queueTurnEvents(std::ostream& gameLog, Player&);
+  void queueSubInfo(std::ostream& gameLog, Player&);
+  void queueScore(std::ostream& gameLog, Player&);
+  void flushAll();
+
+  void clearCommands();
+  void countPendingCommands();
+  void removeSlot(const unsigned slot);
   void exec(std::ostream& gameLog, const Command::CommandType);
-  bool exec(SubmarinePtr&, const SleepCommand&);
-  bool exec(SubmarinePtr&, const MoveCommand&);
-  bool exec(SubmarinePtr&, const SprintCommand&);
-  bool exec(SubmarinePtr&, const MineCommand&);
-  bool exec(SubmarinePtr&, const FireCommand&);
-  bool exec(SubmarinePtr&, const SurfaceCommand&);
-  bool exec(SubmarinePtr&, const PingCommand&);
+  bool execSleep(PlayerPtr&, SubmarinePtr&, const Command&);
+  bool execMove(PlayerPtr&, SubmarinePtr&, const Command&);
+  bool execSprint(PlayerPtr&, SubmarinePtr&, const Command&);
+  bool execMine(PlayerPtr&, SubmarinePtr&, const Command&);
+  bool execFire(PlayerPtr&, SubmarinePtr&, const Command&);
+  bool execSurface(PlayerPtr&, SubmarinePtr&, const Command&);
+  bool execPing(PlayerPtr&, SubmarinePtr&, const Command&);
+
+  void listenForSubs(const Coordinate&,
+                     const unsigned range,
+                     const unsigned playerID);
 
   void executeNuclearDetonations();
   void executeRepairs();
@@ -140,13 +174,13 @@ private: // methods
 
   unsigned blastDistance(const Coordinate& from, const Coordinate& to) const;
 
-  GameMap::TorpedoShot getTorpedoShot(const std::map<Coordinate, unsigned>&,
+  GameMap::TorpedoShot getTorpedoShot(const GameMap::Range&,
                                       const Coordinate& from,
                                       const Coordinate& to,
-                                      const unsigned blastRadius) const;
+                                      const unsigned blastRadius);
 
   std::vector<Coordinate> getBlastCoordinates(const Coordinate&,
-                                              const unsigned range) const;
+                                              const unsigned range);
 };
 
 } // namespace subsim
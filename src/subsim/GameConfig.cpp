@@ -11,6 +11,12 @@
 namespace subsim
 {
 
+//-----------------------------------------------------------------------------
+// game config messages carry the server version, so it lives here where the
+// server and the in-process simulation can both reach it
+//-----------------------------------------------------------------------------
+const Version SERVER_VERSION("1.0.x");
+
 //-----------------------------------------------------------------------------
 static const GameSetting::SettingType _None                = GameSetting::None;
 static const GameSetting::SettingType _MinPlayers          = GameSetting::MinPlayers;
@@ -32,6 +38,12 @@ static const GameSetting::SettingType _SubMaxSprintCharge  = GameSetting::SubMax
 static const GameSetting::SettingType _SubTorpedoCount     = GameSetting::SubTorpedoCount;
 static const GameSetting::SettingType _SubMineCount        = GameSetting::SubMineCount;
 
+//-----------------------------------------------------------------------------
+Version
+GameConfig::getServerVersion() {
+  return SERVER_VERSION;
+}
+
 //-----------------------------------------------------------------------------
 GameConfig::GameConfig() {
   for (unsigned subID = 0; subID < subsPerPlayer; ++subID) {
@@ -57,6 +57,10 @@ public: // constructors
   GameConfig& operator=(GameConfig&&) = default;
   GameConfig& operator=(const GameConfig&) = default;
 
+//-----------------------------------------------------------------------------
+public: // static methods
+  static Version getServerVersion();
+
 //-----------------------------------------------------------------------------
 public: // methods
   void print(const std::string& title, Coordinate&) const;
@@ -71,6 +75,7 @@ public: // getters
   unsigned getMinPlayers() const noexcept { return minPlayers; }
   unsigned getMaxPlayers() const noexcept { return maxPlayers; }
   unsigned getMaxTurns() const noexcept { return maxTurns; }
+  unsigned getTurnTimeout() const noexcept { return turnTimeout; }
   unsigned getMapWidth() const noexcept { return mapWidth; }
   unsigned getMapHeight() const noexcept { return mapHeight; }
   unsigned getSubsPerPlayer() const noexcept { return subsPerPlayer; }
@@ -2,6 +2,7 @@
 // Copyright (c) 2017 Shawn Chidester, All rights reserved
 //-----------------------------------------------------------------------------
 #include "GameMap.h"
+#include "MapSnapshot.h"
 #include "Submarine.h"
 #include "utils/Error.h"
 #include "utils/Movement.h"
@@ -10,108 +11,25 @@
 namespace subsim
 {
 
-//-----------------------------------------------------------------------------
-void
-GameMap::printSquare(Screen& screen, const Square& square) const {
-  const unsigned count = square.getObjectCount();
-  if (count > 1) {
-    ASSERT(!square.isBlocked());
-    screen << rPad(count, 3, ' ');
-  } else if (count) {
-    const Object* obj = square.begin()->get();
-    const Submarine* sub = dynamic_cast<const Submarine*>(obj);
-    const char ch = obj->getMapChar();
-    const std::string str = rPad(toStr(ch), 3, ' ');
-    if (sub) {
-      switch (sub->getShieldCount()) {
-      case 0:
-        screen << BrightRed << str << DefaultColor;
-        break;
-      case 1:
-        screen << BrightMagenta << str << DefaultColor;
-        break;
-      case 2:
-        screen << BrightGreen << str << DefaultColor;
-        break;
-      default:
-        screen << BrightWhite << str << DefaultColor;
-      }
-    } else {
-      screen << str;
-    }
-  } else {
-    screen << "  .";
-  }
-}
-
-//-----------------------------------------------------------------------------
-static Coordinate toScreenCoord(Coordinate coord) {
-  return Coordinate(((coord.getX() * 3) + 1), (coord.getY() + 1));
-}
-
-//-----------------------------------------------------------------------------
-void
-GameMap::animateShot(const Coordinate& mapPos, const TorpedoShot& shot) const {
-  ASSERT(shot.first.size());
-  ASSERT(shot.second.size());
-  Screen& screen = Screen::print() << mapPos;
-  for (const Coordinate& coord : shot.first) {
-    screen << toScreenCoord(coord) << BrightBlue << "  *" << mapPos << Flush;
-    usleep(100000);
-    screen << toScreenCoord(coord) << DefaultColor;
-    printSquare(screen, getSquare(coord));
-  }
-
-  unsigned count = 0;
-  const Coordinate& finalDest = shot.first.back();
-  for (unsigned dist = 0; count < shot.second.size(); ++dist) {
-    for (const Coordinate& coord : shot.second) {
-      if (finalDest.blastDistanceTo(coord) == dist) {
-        screen << toScreenCoord(coord) << Red << "  X";
-        count++;
-      }
-    }
-    screen << mapPos << Flush;
-    usleep(250000);
-  }
-  usleep(250000);
-
-  for (Coordinate coord : shot.second) {
-    screen << toScreenCoord(coord) << DefaultColor;
-    printSquare(screen, getSquare(coord));
-  }
-  screen.flush();
-}
-
 //-----------------------------------------------------------------------------
 void
 GameMap::print(Coordinate& coord) const {
-  Screen& screen = Screen::print() << coord << "   ";
-  for (unsigned x = 1; x <= getWidth(); ++x) {
-    screen << rPad(x, 3, ' ');
-  }
-  for (unsigned y = 1; y <= getHeight(); ++y) {
-    screen << coord.south() << rPad(y, 3, ' ');
-    for (unsigned x = 1; x <= getWidth(); ++x) {
-      printSquare(screen, getSquare(Coordinate(x, y)));
-    }
-  }
-  screen << coord.south(2);
+  MapSnapshot(*this, 0).print(coord);
 }
 
 //-----------------------------------------------------------------------------
 void
 GameMap::printSummary(Coordinate& coord) const {
   unsigned count = 0;
-  for (const UniqueSquare& square : squares) {
-    count += square->getObjectCount();
+  for (const Square& square : squares) {
+    count += square.getObjectCount();
   }
 
   Screen& screen = Screen::print() << coord << "Object Count: " << count;
   if (count) {
     unsigned tmp = 0;
-    for (const UniqueSquare& square : squares) {
-      for (const ObjectPtr& object : (*square)) {
+    for (const Square& square : squares) {
+      for (const Object* object : square) {
         if (!object->isPermanent()) {
           if (!tmp++) {
             screen << coord.south().setX(4);
@@ -133,13 +51,16 @@ GameMap::reset(const unsigned width, const unsigned height) {
 
   squares.clear();
   squares.reserve(getSize());
+  obstacles.clear();
+  mines.clear();
+  freeMines.clear();
 
   for (unsigned y = 1; y <= height; ++y) {
     for (unsigned x = 1; x <= width; ++x) {
-      squares.push_back(std::make_unique<Square>(x, y));
+      squares.emplace_back(x, y);
 #ifndef NDEBUG
       const unsigned idx = (squares.size() - 1);
-      const Square& square = (*squares[idx]);
+      const Square& square = squares[idx];
       const unsigned i = toIndex(square);
       ASSERT(i == idx);
       ASSERT(square.getX() == x);
@@ -148,11 +69,17 @@ GameMap::reset(const unsigned width, const unsigned height) {
     }
   }
   ASSERT(squares.size() == getSize());
+
+  rangeStamps.assign(getSize(), 0);
+  rangeDistances.resize(getSize());
+  rangeOrder.clear();
+  rangeOrder.reserve(getSize());
+  rangeEpoch = 0;
 }
 
 //-----------------------------------------------------------------------------
 void
-GameMap::addObject(const Coordinate& coord, ObjectPtr object) {
+GameMap::addObject(const Coordinate& coord, Object* object) {
   Square& square = getSquare(coord);
   if (square.isBlocked()) {
     throw Error(Msg() << square << " is blocked, can't add objects to it");
@@ -164,7 +91,7 @@ GameMap::addObject(const Coordinate& coord, ObjectPtr object) {
 
 //-----------------------------------------------------------------------------
 void
-GameMap::removeObject(const Coordinate& coord, ObjectPtr object) {
+GameMap::removeObject(const Coordinate& coord, Object* object) {
   Square& square = getSquare(coord);
   if (!square.removeObject(object)) {
     throw Error(Msg() << square << " does not contain " << (*object));
@@ -176,7 +103,7 @@ GameMap::removeObject(const Coordinate& coord, ObjectPtr object) {
 void
 GameMap::moveObject(const Coordinate& from,
                     const Coordinate& to,
-                    ObjectPtr object)
+                    Object* object)
 {
   Square& fromSquare = getSquare(from);
   Square& toSquare = getSquare(to);
@@ -193,65 +120,156 @@ GameMap::moveObject(const Coordinate& from,
 }
 
 //-----------------------------------------------------------------------------
-std::map<Coordinate, unsigned>
-GameMap::squaresInRangeOf(const Coordinate& coord,
-                          const unsigned range) const
+void
+GameMap::addObstacle(const Coordinate& coord) {
+  obstacles.emplace_back();
+  addObject(coord, &obstacles.back());
+}
+
+//-----------------------------------------------------------------------------
+void
+GameMap::addMine(const Coordinate& coord,
+                 const unsigned playerID,
+                 const char mapChar)
 {
-  if (!contains(coord)) {
-    throw Error(Msg() << "Invalid coordinates: " << coord);
+  Mine* mine = nullptr;
+  if (freeMines.size()) {
+    mine = freeMines.back();
+    freeMines.pop_back();
+    (*mine) = Mine(playerID, mapChar);
+  } else {
+    mines.emplace_back(playerID, mapChar);
+    mine = &mines.back();
+  }
+  try {
+    addObject(coord, mine);
+  } catch (...) {
+    freeMines.push_back(mine);
+    throw;
   }
-  std::map<Coordinate, unsigned> destinations;
-  destinations[coord] = 0;
-  if (range > 0) {
-    addDestinations(destinations, coord, 1, range);
+}
+
+//-----------------------------------------------------------------------------
+void
+GameMap::clearMines(Square& square) {
+  for (auto it = square.begin(); square.hasMines(); ) {
+    ASSERT(it != square.end());
+    if ((*it)->isMine()) {
+      Mine* mine = static_cast<Mine*>(*it);
+      mine->setLocation(Coordinate());
+      freeMines.push_back(mine);
+      it = square.erase(it);
+    } else {
+      it++;
+    }
   }
-  return std::move(destinations);
 }
 
+//-----------------------------------------------------------------------------
+// Remove every mine from the map, mines not on the map have no location
 //-----------------------------------------------------------------------------
 void
-GameMap::addDestinations(std::map<Coordinate, unsigned>& dests,
-                         const Coordinate& coord,
-                         const unsigned distance,
-                         const unsigned range) const
+GameMap::clearMines() {
+  for (Mine& mine : mines) {
+    if (mine.getLocation()) {
+      getSquare(mine.getLocation()).removeObject(&mine);
+      mine.setLocation(Coordinate());
+      freeMines.push_back(&mine);
+    }
+  }
+  ASSERT(freeMines.size() == mines.size());
+}
+
+//-----------------------------------------------------------------------------
+GameMap::Range
+GameMap::squaresInRangeOf(const Coordinate& coord,
+                          const unsigned range) const
 {
-  ASSERT(distance <= range);
-  std::vector<unsigned> next;
-  for (Direction dir : {
-       Direction::North,
-       Direction::East,
-       Direction::South,
-       Direction::West })
-  {
-    const unsigned destIndex = toIndex(coord + dir);
-    if (destIndex < squares.size()) {
-      Square& dest = (*squares[destIndex]);
-      const auto it = dests.find(dest);
-      const unsigned previousDist = (it == dests.end()) ? ~0U : it->second;
-      if (distance < previousDist) {
-        dests[dest] = distance;
-        if (dest.isEmpty()) {
-          next.push_back(destIndex);
-        }
+  const unsigned start = toIndex(coord);
+  if (start >= squares.size()) {
+    throw Error(Msg() << "Invalid coordinates: " << coord);
+  }
+
+  // a new epoch invalidates every stamp from previous queries at once
+  if (!++rangeEpoch) {
+    std::fill(rangeStamps.begin(), rangeStamps.end(), 0);
+    rangeEpoch = 1;
+  }
+
+  rangeOrder.clear();
+  rangeOrder.push_back(start);
+  rangeStamps[start] = rangeEpoch;
+  rangeDistances[start] = 0;
+
+  // breadth first, only the start square and empty squares are passable
+  const unsigned width = getWidth();
+  const unsigned height = getHeight();
+  for (unsigned head = 0; head < rangeOrder.size(); ++head) {
+    const unsigned idx = rangeOrder[head];
+    const unsigned distance = rangeDistances[idx];
+    if (distance >= range) {
+      break;
+    } else if (head && !squares[idx].isEmpty()) {
+      continue;
+    }
+
+    const unsigned x = (idx % width);
+    const unsigned y = (idx / width);
+    const unsigned neighbors[] = {
+      (y > 0) ? (idx - width) : ~0U,
+      ((x + 1) < width) ? (idx + 1) : ~0U,
+      ((y + 1) < height) ? (idx + width) : ~0U,
+      (x > 0) ? (idx - 1) : ~0U
+    };
+
+    for (const unsigned next : neighbors) {
+      if ((next != ~0U) && (rangeStamps[next] != rangeEpoch)) {
+        rangeStamps[next] = rangeEpoch;
+        rangeDistances[next] = (distance + 1);
+        rangeOrder.push_back(next);
       }
     }
   }
 
-  if (distance < range) {
-    for (unsigned idx : next) {
-      addDestinations(dests, (*squares[idx]), (distance + 1), range);
-    }
+  return Range((*this), rangeEpoch);
+}
+
+//-----------------------------------------------------------------------------
+const Square&
+GameMap::getSquare(const Coordinate& coord) const {
+  const unsigned idx = toIndex(coord);
+  if (idx < squares.size()) {
+    return squares[idx];
+  }
+  throw Error(Msg() << "Invalid coordinates: " << coord);
+}
+
+//-----------------------------------------------------------------------------
+const Square&
+GameMap::getSquare(const unsigned index) const {
+  if (index < squares.size()) {
+    return squares[index];
   }
+  throw Error(Msg() << "Invalid square index: " << index);
 }
 
 //-----------------------------------------------------------------------------
 Square&
-GameMap::getSquare(const Coordinate& coord) const {
+GameMap::getSquare(const Coordinate& coord) {
   const unsigned idx = toIndex(coord);
   if (idx < squares.size()) {
-    return (*squares[idx]);
+    return squares[idx];
   }
   throw Error(Msg() << "Invalid coordinates: " << coord);
 }
 
+//-----------------------------------------------------------------------------
+Square&
+GameMap::getSquare(const unsigned index) {
+  if (index < squares.size()) {
+    return squares[index];
+  }
+  throw Error(Msg() << "Invalid square index: " << index);
+}
+
 } // namespace subsim
@@ -8,8 +8,11 @@
 #include "utils/Coordinate.h"
 #include "utils/Rectangle.h"
 #include "utils/Screen.h"
+#include "Mine.h"
 #include "Object.h"
+#include "Obstacle.h"
 #include "Square.h"
+#include <deque>
 
 namespace subsim
 {
@@ -20,9 +23,60 @@ class GameMap : public Rectangle {
 public: // typedefs
   typedef std::pair<std::vector<Coordinate>, std::vector<Coordinate>> TorpedoShot;
 
+//-----------------------------------------------------------------------------
+// Result of a squaresInRangeOf() query.  Iterates the indexes of the squares
+// reached in order of increasing distance.  Refers to buffers owned by the
+// GameMap, so it is only valid until the next squaresInRangeOf() call.
+//-----------------------------------------------------------------------------
+class Range {
+  friend class GameMap;
+
+  const GameMap& gameMap;
+  const unsigned epoch;
+
+  Range(const GameMap& gameMap, const unsigned epoch) noexcept
+    : gameMap(gameMap),
+      epoch(epoch)
+  { }
+
+public:
+  std::vector<unsigned>::const_iterator begin() const noexcept {
+    return gameMap.rangeOrder.begin();
+  }
+
+  std::vector<unsigned>::const_iterator end() const noexcept {
+    return gameMap.rangeOrder.end();
+  }
+
+  unsigned size() const noexcept {
+    return gameMap.rangeOrder.size();
+  }
+
+  unsigned distanceAt(const unsigned squareIndex) const noexcept {
+    ASSERT(epoch == gameMap.rangeEpoch);
+    return ((squareIndex < gameMap.rangeStamps.size()) &&
+            (gameMap.rangeStamps[squareIndex] == epoch))
+        ? gameMap.rangeDistances[squareIndex]
+        : ~0U;
+  }
+
+  unsigned distanceTo(const Coordinate& coord) const noexcept {
+    return distanceAt(gameMap.toIndex(coord));
+  }
+};
+
 //-----------------------------------------------------------------------------
 private: // variables
-  std::vector<UniqueSquare> squares;
+  std::vector<Square> squares;
+  std::deque<Obstacle> obstacles;
+  std::deque<Mine> mines;
+  std::vector<Mine*> freeMines; // released mines available for reuse
+
+  // squaresInRangeOf() work buffers, reused by every query
+  mutable std::vector<unsigned> rangeStamps;    // epoch when square reached
+  mutable std::vector<unsigned> rangeDistances; // valid if stamp is current
+  mutable std::vector<unsigned> rangeOrder;     // BFS queue of square indexes
+  mutable unsigned rangeEpoch = 0;
 
 //-----------------------------------------------------------------------------
 public: // constructors
@@ -34,30 +88,32 @@ public: // constructors
 
 //-----------------------------------------------------------------------------
 public: // methods
-  void animateShot(const Coordinate& mapPos, const TorpedoShot& shot) const;
+  unsigned getMineCount() const noexcept {
+    return (mines.size() - freeMines.size());
+  }
+
   void print(Coordinate&) const;
   void printSummary(Coordinate&) const;
   void reset(const unsigned width, const unsigned height);
-  void addObject(const Coordinate&, ObjectPtr);
-  void removeObject(const Coordinate&, ObjectPtr);
-  void moveObject(const Coordinate& from, const Coordinate& to, ObjectPtr);
+  void addObject(const Coordinate&, Object*);
+  void removeObject(const Coordinate&, Object*);
+  void moveObject(const Coordinate& from, const Coordinate& to, Object*);
+  void addObstacle(const Coordinate&);
+  void addMine(const Coordinate&, const unsigned playerID, const char mapChar);
+  void clearMines(Square&);
+  void clearMines();
   bool isBlocked(const Coordinate&) const noexcept;
-  Square& getSquare(const Coordinate&) const;
-
-  std::map<Coordinate, unsigned> squaresInRangeOf(
-      const Coordinate& coord,
-      const unsigned range) const;
+  const Square& getSquare(const Coordinate&) const;
+  const Square& getSquare(const unsigned index) const;
+  Square& getSquare(const Coordinate&);
+  Square& getSquare(const unsigned index);
+  Range squaresInRangeOf(const Coordinate& coord, const unsigned range) const;
 
 //-----------------------------------------------------------------------------
 private: // methods
-  void printSquare(Screen& screen, const Square& square) const;
   void printRow(Screen& screen, const Coordinate& rowCenter) const;
   void printRow(Screen& screen, const Coordinate& rowCenter,
                 const ScreenColor color, const std::string& str) const;
-  void addDestinations(std::map<Coordinate, unsigned>& destinations,
-                       const Coordinate& to,
-                       const unsigned dist,
-                       const unsigned range) const;
 };
 
 } // namespace subsim
@@ -0,0 +1,77 @@
+//-----------------------------------------------------------------------------
+// Copyright (c) 2017 Shawn Chidester, All rights reserved
+//-----------------------------------------------------------------------------
+#include "GameState.h"
+#include <type_traits>
+
+namespace subsim
+{
+
+//-----------------------------------------------------------------------------
+static_assert(std::is_trivially_copyable<Random>::value &&
+              std::is_trivially_copyable<Submarine::State>::value &&
+              std::is_trivially_copyable<GameState::PlayerInfo>::value &&
+              std::is_trivially_copyable<GameState::SubInfo>::value &&
+              std::is_trivially_copyable<GameState::MineInfo>::value,
+              "GameState is copied with memcpy");
+
+//-----------------------------------------------------------------------------
+// Sections start on 8 byte boundaries so every record is aligned
+//-----------------------------------------------------------------------------
+static std::size_t align(const std::size_t size) noexcept {
+  return ((size + 7) & ~static_cast<std::size_t>(7));
+}
+
+//-----------------------------------------------------------------------------
+std::size_t
+GameState::playersOffset() const noexcept {
+  return align(sizeof(Header));
+}
+
+//-----------------------------------------------------------------------------
+std::size_t
+GameState::subsOffset() const noexcept {
+  return align(playersOffset() +
+               (header().playerCount * sizeof(PlayerInfo)));
+}
+
+//-----------------------------------------------------------------------------
+std::size_t
+GameState::minesOffset() const noexcept {
+  return align(subsOffset() + (header().playerCount *
+                               header().subsPerPlayer * sizeof(SubInfo)));
+}
+
+//-----------------------------------------------------------------------------
+std::size_t
+GameState::gridOffset() const noexcept {
+  return align(minesOffset() + (header().mineCount * sizeof(MineInfo)));
+}
+
+//-----------------------------------------------------------------------------
+// Size the buffer for the given counts, keeps its capacity so states that
+// are saved over and over stop allocating once they've seen the most mines
+//-----------------------------------------------------------------------------
+void
+GameState::reset(const unsigned playerCount,
+                 const unsigned subsPerPlayer,
+                 const unsigned mineCount,
+                 const unsigned width,
+                 const unsigned height)
+{
+  Header head;
+  head.aborted = 0;
+  head.finished = 0;
+  head.turnNumber = 0;
+  head.playerCount = playerCount;
+  head.subsPerPlayer = subsPerPlayer;
+  head.mineCount = mineCount;
+  head.width = width;
+  head.height = height;
+
+  data.resize(playersOffset() / 8);
+  header() = head;
+  data.resize((gridOffset() + (width * height) + 7) / 8);
+}
+
+} // namespace subsim
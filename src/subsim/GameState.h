@@ -0,0 +1,185 @@
+//-----------------------------------------------------------------------------
+// Copyright (c) 2017 Shawn Chidester, All rights reserved
+//-----------------------------------------------------------------------------
+#ifndef SUBSIM_GAME_STATE_H
+#define SUBSIM_GAME_STATE_H
+
+#include "utils/Platform.h"
+#include "utils/Coordinate.h"
+#include "utils/Random.h"
+#include "Submarine.h"
+
+namespace subsim
+{
+
+//-----------------------------------------------------------------------------
+// A snapshot of a game between turns, filled by Game::saveState() and put
+// back with Game::restoreState() so turns can be tried from the same start
+// over and over.  Players, subs, mines and the occupancy grid are plain
+// data packed into one buffer, so copying a GameState is a single memcpy
+// (and no allocation once the destination is big enough).
+//-----------------------------------------------------------------------------
+class GameState {
+//-----------------------------------------------------------------------------
+public: // enums
+  enum SquareFlags : uint8_t {
+    Blocked    = 0x01,
+    HasMines   = 0x02,
+    HasSubs    = 0x04
+  };
+
+//-----------------------------------------------------------------------------
+public: // types
+  struct PlayerInfo {
+    unsigned playerID;
+    unsigned score;
+  };
+
+  struct SubInfo {
+    Submarine::State state;
+    unsigned mapOrder; // when the sub was added to its square, ~0U = off map
+  };
+
+  struct MineInfo {
+    uint16_t x;
+    uint16_t y;
+    unsigned playerID;
+    unsigned mapOrder;
+    char mapChar;
+  };
+
+//-----------------------------------------------------------------------------
+private: // types
+  struct Header {
+    Random rng;
+    uint64_t aborted;
+    uint64_t finished;
+    unsigned turnNumber;
+    unsigned playerCount;
+    unsigned subsPerPlayer;
+    unsigned mineCount;
+    unsigned width;
+    unsigned height;
+  };
+
+//-----------------------------------------------------------------------------
+private: // variables
+  // Header, PlayerInfo[playerCount], SubInfo[playerCount * subsPerPlayer],
+  // MineInfo[mineCount], then one SquareFlags byte per map square
+  std::vector<uint64_t> data;
+
+//-----------------------------------------------------------------------------
+public: // constructors
+  GameState() = default;
+  GameState(GameState&&) noexcept = default;
+  GameState(const GameState&) = default;
+  GameState& operator=(GameState&&) noexcept = default;
+  GameState& operator=(const GameState&) = default;
+
+//-----------------------------------------------------------------------------
+public: // getters
+  bool isEmpty() const noexcept { return data.empty(); }
+  std::size_t getByteCount() const noexcept { return (data.size() * 8); }
+
+  unsigned getTurnNumber() const noexcept { return header().turnNumber; }
+  unsigned getPlayerCount() const noexcept { return header().playerCount; }
+  unsigned getSubsPerPlayer() const noexcept { return header().subsPerPlayer; }
+  unsigned getMineCount() const noexcept { return header().mineCount; }
+  unsigned getWidth() const noexcept { return header().width; }
+  unsigned getHeight() const noexcept { return header().height; }
+  bool isFinished() const noexcept {
+    return (header().aborted || header().finished);
+  }
+
+  const PlayerInfo& getPlayer(const unsigned slot) const noexcept {
+    ASSERT(slot < getPlayerCount());
+    return players()[slot];
+  }
+
+  const SubInfo& getSub(const unsigned slot,
+                        const unsigned subID) const noexcept
+  {
+    ASSERT((slot < getPlayerCount()) && (subID < getSubsPerPlayer()));
+    return subs()[(slot * getSubsPerPlayer()) + subID];
+  }
+
+  const MineInfo& getMine(const unsigned idx) const noexcept {
+    ASSERT(idx < getMineCount());
+    return mines()[idx];
+  }
+
+  uint8_t getSquare(const Coordinate& coord) const noexcept {
+    ASSERT(coord.getX() && (coord.getX() <= getWidth()));
+    ASSERT(coord.getY() && (coord.getY() <= getHeight()));
+    return grid()[((coord.getY() - 1) * getWidth()) + (coord.getX() - 1)];
+  }
+
+//-----------------------------------------------------------------------------
+private: // methods
+  friend class Game;
+
+  void reset(const unsigned playerCount,
+             const unsigned subsPerPlayer,
+             const unsigned mineCount,
+             const unsigned width,
+             const unsigned height);
+
+  std::size_t playersOffset() const noexcept;
+  std::size_t subsOffset() const noexcept;
+  std::size_t minesOffset() const noexcept;
+  std::size_t gridOffset() const noexcept;
+
+  const char* bytes() const noexcept {
+    return reinterpret_cast<const char*>(data.data());
+  }
+
+  char* bytes() noexcept {
+    return reinterpret_cast<char*>(data.data());
+  }
+
+  const Header& header() const noexcept {
+    ASSERT(!isEmpty());
+    return (*reinterpret_cast<const Header*>(bytes()));
+  }
+
+  Header& header() noexcept {
+    ASSERT(!isEmpty());
+    return (*reinterpret_cast<Header*>(bytes()));
+  }
+
+  const PlayerInfo* players() const noexcept {
+    return reinterpret_cast<const PlayerInfo*>(bytes() + playersOffset());
+  }
+
+  PlayerInfo* players() noexcept {
+    return reinterpret_cast<PlayerInfo*>(bytes() + playersOffset());
+  }
+
+  const SubInfo* subs() const noexcept {
+    return reinterpret_cast<const SubInfo*>(bytes() + subsOffset());
+  }
+
+  SubInfo* subs() noexcept {
+    return reinterpret_cast<SubInfo*>(bytes() + subsOffset());
+  }
+
+  const MineInfo* mines() const noexcept {
+    return reinterpret_cast<const MineInfo*>(bytes() + minesOffset());
+  }
+
+  MineInfo* mines() noexcept {
+    return reinterpret_cast<MineInfo*>(bytes() + minesOffset());
+  }
+
+  const uint8_t* grid() const noexcept {
+    return reinterpret_cast<const uint8_t*>(bytes() + gridOffset());
+  }
+
+  uint8_t* grid() noexcept {
+    return reinterpret_cast<uint8_t*>(bytes() + gridOffset());
+  }
+};
+
+} // namespace subsim
+
+#endif // SUBSIM_GAME_STATE_H
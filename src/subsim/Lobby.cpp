@@ -0,0 +1,221 @@
+//-----------------------------------------------------------------------------
+// Copyright (c) 2017 Shawn Chidester, All rights reserved
+//-----------------------------------------------------------------------------
+#include "Lobby.h"
+#include "utils/CommandArgs.h"
+#include "utils/Error.h"
+#include "utils/Logger.h"
+#include "utils/Msg.h"
+#include "utils/Screen.h"
+#include "utils/StringUtils.h"
+#include <iostream>
+
+namespace subsim
+{
+
+//-----------------------------------------------------------------------------
+const std::string UNKNOWN_TITLE("unknown game title");
+const unsigned MAX_TITLE_SIZE = 20;
+
+//-----------------------------------------------------------------------------
+bool
+Lobby::run(const unsigned roomCount) {
+  bool ok = true;
+  try {
+    headless = CommandArgs::getInstance().has("--headless");
+    wakeup.open();
+    input.addHandle(wakeup.getReadHandle(), "lobby");
+    const bool interactive = isatty(STDIN_FILENO);
+    if (interactive) {
+      input.addHandle(STDIN_FILENO);
+    }
+
+    openRooms(roomCount);
+    startListening();
+
+    report(Msg() << "Hosting " << roomCount << " rooms on "
+           << socket.getAddress() << ':' << socket.getPort()
+           << (interactive ? ", enter Q to quit" : ""));
+
+    std::set<int> ready;
+    bool quit = false;
+    while (!quit) {
+      const int timeout = waiting.empty() ? -1 : RETRY_INTERVAL;
+      Logger::getInstance().flush();
+      input.waitForData(ready, timeout);
+      for (const int handle : ready) {
+        if (handle == socket.getHandle()) {
+          Socket connection = socket.accept();
+          if (connection) {
+            dispatch(std::move(connection), "");
+          }
+        } else if (handle == wakeup.getReadHandle()) {
+          takeRouting();
+        } else if (handle == STDIN_FILENO) {
+          quit = !handleUserInput();
+        }
+      }
+
+      // seats open up as games finish and players drop out
+      std::vector<Socket> retry;
+      retry.swap(waiting);
+      for (Socket& connection : retry) {
+        dispatch(std::move(connection), "");
+      }
+    }
+  }
+  catch (const std::exception& e) {
+    Logger::printError() << e.what();
+    ok = false;
+  }
+
+  close();
+  return ok;
+}
+
+//-----------------------------------------------------------------------------
+void
+Lobby::route(Socket&& connection, const std::string& title) {
+  {
+    std::lock_guard<std::mutex> lock(routingMutex);
+    routing.push_back(Routing { std::move(connection), title });
+  }
+  wakeup.writeln();
+}
+
+//-----------------------------------------------------------------------------
+bool
+Lobby::handleUserInput() {
+  if (input.readln(STDIN_FILENO) && iStartsWith(input.getStr(), 'Q')) {
+    return false;
+  }
+
+  for (const auto& room : rooms) {
+    report(Msg() << "Room " << room->getRoomNumber() << " '"
+           << room->getRoomTitle() << "' "
+           << (room->isAccepting() ? "open" : "closed"));
+  }
+  report(Msg() << waiting.size() << " waiting for a seat, enter Q to quit");
+  return true;
+}
+
+//-----------------------------------------------------------------------------
+// Screen needs a terminal, a headless lobby may not have one
+//-----------------------------------------------------------------------------
+void
+Lobby::report(const std::string& status) {
+  if (headless) {
+    std::cout << status << std::endl;
+  } else {
+    Screen::print() << status << EL << Flush;
+  }
+}
+
+//-----------------------------------------------------------------------------
+// Connections asking for a title go to that room whether or not it has a
+// seat, the room reports a full game the same way a lone server does
+//-----------------------------------------------------------------------------
+void
+Lobby::dispatch(Socket&& connection, const std::string& title) {
+  if (title.size()) {
+    for (const auto& room : rooms) {
+      if (iEqual(room->getRoomTitle(), title)) {
+        room->handoff(std::move(connection), true);
+        return;
+      }
+    }
+    LOG_DEBUG << connection << " requested unknown room: " << title;
+    connection.send(UNKNOWN_TITLE);
+    return;
+  }
+
+  for (const auto& room : rooms) {
+    if (room->isAccepting()) {
+      LOG_DEBUG << connection << " sent to room "
+                << room->getRoomNumber();
+      room->handoff(std::move(connection));
+      return;
+    }
+  }
+  waiting.push_back(std::move(connection));
+}
+
+//-----------------------------------------------------------------------------
+void
+Lobby::close() {
+  for (auto& room : rooms) {
+    room->stop();
+  }
+  for (std::thread& thread : threads) {
+    thread.join();
+  }
+  threads.clear();
+  rooms.clear();
+  routing.clear();
+  waiting.clear();
+
+  if (socket) {
+    input.removeHandle(socket.getHandle());
+    socket.close();
+  }
+}
+
+//-----------------------------------------------------------------------------
+void
+Lobby::openRooms(const unsigned roomCount) {
+  if (!roomCount || (roomCount > static_cast<unsigned>(MAX_ROOMS))) {
+    throw Error(Msg() << "Invalid lobby room count: " << roomCount
+                << ", must be 1 to " << MAX_ROOMS);
+  }
+
+  std::string title = CommandArgs::getInstance().getStrAfter({"-t",
+                                                              "--title"});
+  if (isEmpty(title)) {
+    title = "Room";
+  }
+  if (contains(title, '|') ||
+      ((title.size() + 1 + toStr(roomCount).size()) > MAX_TITLE_SIZE))
+  {
+    throw Error(Msg() << "Invalid lobby title: " << title);
+  }
+
+  for (unsigned i = 1; i <= roomCount; ++i) {
+    rooms.emplace_back(new Server((*this), i, (title + ' ' + toStr(i))));
+  }
+  for (auto& room : rooms) {
+    threads.emplace_back(&Server::host, room.get());
+  }
+}
+
+//-----------------------------------------------------------------------------
+void
+Lobby::startListening() {
+  const CommandArgs& args = CommandArgs::getInstance();
+  const std::string bindAddress = args.getStrAfter({"-b", "--bind-address"});
+  const int bindPort = args.getIntAfter({"-p", "--port"},
+                                        Server::DEFAULT_PORT);
+
+  socket.listen(bindAddress, bindPort, (rooms.size() * 10));
+  input.addHandle(socket.getHandle());
+}
+
+//-----------------------------------------------------------------------------
+void
+Lobby::takeRouting() {
+  char buf[256];
+  if (::read(wakeup.getReadHandle(), buf, sizeof(buf)) < 0) {
+    Logger::error() << "Lobby wakeup read failed: " << toError(errno);
+  }
+
+  std::vector<Routing> batch;
+  {
+    std::lock_guard<std::mutex> lock(routingMutex);
+    batch.swap(routing);
+  }
+
+  for (Routing& r : batch) {
+    dispatch(std::move(r.connection), r.title);
+  }
+}
+
+} // namespace subsim
@@ -0,0 +1,83 @@
+//-----------------------------------------------------------------------------
+// Copyright (c) 2017 Shawn Chidester, All rights reserved
+//-----------------------------------------------------------------------------
+#ifndef SUBSIM_LOBBY_H
+#define SUBSIM_LOBBY_H
+
+#include "utils/Platform.h"
+#include "utils/Input.h"
+#include "utils/Pipe.h"
+#include "utils/Socket.h"
+#include "Server.h"
+#include <mutex>
+#include <thread>
+
+namespace subsim
+{
+
+//-----------------------------------------------------------------------------
+// Hosts several games at once.  The lobby owns the listening socket and
+// routes each new connection to a room, every room is a Server running its
+// own game on its own thread.  Rooms hand connections back via route() when
+// a client asks for another room or when a room fills before it gets there.
+//-----------------------------------------------------------------------------
+class Lobby {
+//-----------------------------------------------------------------------------
+public: // enums
+  enum {
+    MAX_ROOMS = 64,
+    RETRY_INTERVAL = 250 // ms between seat checks while connections wait
+  };
+
+//-----------------------------------------------------------------------------
+private: // types
+  struct Routing {
+    Socket connection;
+    std::string title; // empty = any room with an open seat
+  };
+
+//-----------------------------------------------------------------------------
+private: // variables
+  Input input;
+  Socket socket;
+  Pipe wakeup;
+  std::vector<std::unique_ptr<Server>> rooms;
+  std::vector<std::thread> threads;
+  std::mutex routingMutex;
+  std::vector<Routing> routing; // handed back by rooms, guarded by mutex
+  std::vector<Socket> waiting;  // no room had an open seat
+  bool headless = false;        // status goes to stdout, Screen unused
+
+//-----------------------------------------------------------------------------
+public: // constructors
+  Lobby() = default;
+  Lobby(Lobby&&) = delete;
+  Lobby(const Lobby&) = delete;
+  Lobby& operator=(Lobby&&) = delete;
+  Lobby& operator=(const Lobby&) = delete;
+
+//-----------------------------------------------------------------------------
+public: // destructor
+  ~Lobby() { close(); }
+
+//-----------------------------------------------------------------------------
+public: // methods
+  bool run(const unsigned roomCount);
+
+  // thread safe, may be called by any room
+  void route(Socket&&, const std::string& title = "");
+
+//-----------------------------------------------------------------------------
+private: // methods
+  bool handleUserInput();
+  void dispatch(Socket&&, const std::string& title);
+  void close();
+  void openRooms(const unsigned roomCount);
+  void report(const std::string& status);
+  void startListening();
+  void takeRouting();
+};
+
+} // namespace subsim
+
+#endif // SUBSIM_LOBBY_H
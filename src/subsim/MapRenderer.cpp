@@ -0,0 +1,170 @@
+//-----------------------------------------------------------------------------
+// Copyright (c) 2017 Shawn Chidester, All rights reserved
+//-----------------------------------------------------------------------------
+#include "MapRenderer.h"
+#include "utils/Logger.h"
+#include "utils/Screen.h"
+
+namespace subsim
+{
+
+//-----------------------------------------------------------------------------
+static Coordinate toScreenCoord(const Coordinate& topLeft,
+                                const Coordinate& coord)
+{
+  return Coordinate((topLeft.getX() + (coord.getX() * 3)),
+                    (topLeft.getY() + coord.getY()));
+}
+
+//-----------------------------------------------------------------------------
+void
+MapRenderer::start(const Coordinate& topLeft, const bool animate) {
+  stop();
+  this->topLeft = topLeft;
+  this->animate = animate;
+  stopping = draining = false;
+  running = true;
+  thread = std::thread(&MapRenderer::run, this);
+}
+
+//-----------------------------------------------------------------------------
+void
+MapRenderer::submit(std::shared_ptr<const MapSnapshot> snapshot) {
+  {
+    std::lock_guard<std::mutex> lock(mutex);
+    pending = std::move(snapshot);
+  }
+  wakeup.notify_one();
+}
+
+//-----------------------------------------------------------------------------
+void
+MapRenderer::stop(const bool drain) {
+  if (!running) {
+    return;
+  }
+  {
+    std::lock_guard<std::mutex> lock(mutex);
+    stopping = true;
+    draining = drain;
+  }
+  wakeup.notify_one();
+  thread.join();
+  pending.reset();
+  running = false;
+}
+
+//-----------------------------------------------------------------------------
+void
+MapRenderer::run() {
+  try {
+    std::shared_ptr<const MapSnapshot> snapshot;
+    while ((snapshot = next())) {
+      draw(*snapshot);
+      if (animate) {
+        for (const GameMap::TorpedoShot& shot : snapshot->shotsFired()) {
+          if (!animateShot(*snapshot, shot)) {
+            break;
+          }
+        }
+      }
+      pause(FRAME_INTERVAL);
+    }
+  }
+  catch (const std::exception& e) {
+    Logger::error() << "Map renderer failed: " << e.what();
+  }
+}
+
+//-----------------------------------------------------------------------------
+// wait for a snapshot to draw, returns null when it's time to stop
+//-----------------------------------------------------------------------------
+std::shared_ptr<const MapSnapshot>
+MapRenderer::next() {
+  std::unique_lock<std::mutex> lock(mutex);
+  wakeup.wait(lock, [this] { return (stopping || pending); });
+  if (!pending || (stopping && !draining)) {
+    return nullptr;
+  }
+  return std::move(pending);
+}
+
+//-----------------------------------------------------------------------------
+// returns false if stop was requested before the given time passed,
+// a draining stop lets the current snapshot finish
+//-----------------------------------------------------------------------------
+bool
+MapRenderer::pause(const unsigned ms) {
+  std::unique_lock<std::mutex> lock(mutex);
+  return !wakeup.wait_for(lock, std::chrono::milliseconds(ms), [this] {
+    return (stopping && !draining);
+  });
+}
+
+//-----------------------------------------------------------------------------
+void
+MapRenderer::draw(const MapSnapshot& snapshot) {
+  std::lock_guard<std::mutex> lock(Screen::getMutex());
+  Coordinate coord(topLeft);
+  Screen::print() << SaveCursor;
+  snapshot.print(coord);
+  Screen::print() << RestoreCursor << Flush;
+}
+
+//-----------------------------------------------------------------------------
+bool
+MapRenderer::animateShot(const MapSnapshot& snapshot,
+                         const GameMap::TorpedoShot& shot)
+{
+  ASSERT(shot.first.size());
+  ASSERT(shot.second.size());
+  Screen& screen = Screen::print();
+  for (const Coordinate& coord : shot.first) {
+    {
+      std::lock_guard<std::mutex> lock(Screen::getMutex());
+      screen << SaveCursor << toScreenCoord(topLeft, coord) << BrightBlue
+             << "  *" << DefaultColor << RestoreCursor << Flush;
+    }
+    const bool ok = pause(TORPEDO_STEP);
+    {
+      std::lock_guard<std::mutex> lock(Screen::getMutex());
+      screen << SaveCursor << toScreenCoord(topLeft, coord);
+      snapshot.printSquare(screen, coord);
+      screen << RestoreCursor << Flush;
+    }
+    if (!ok) {
+      return false;
+    }
+  }
+
+  unsigned count = 0;
+  const Coordinate& finalDest = shot.first.back();
+  for (unsigned dist = 0; count < shot.second.size(); ++dist) {
+    {
+      std::lock_guard<std::mutex> lock(Screen::getMutex());
+      screen << SaveCursor;
+      for (const Coordinate& coord : shot.second) {
+        if (finalDest.blastDistanceTo(coord) == dist) {
+          screen << toScreenCoord(topLeft, coord) << Red << "  X";
+          count++;
+        }
+      }
+      screen << DefaultColor << RestoreCursor << Flush;
+    }
+    if (!pause(BLAST_STEP)) {
+      break;
+    }
+  }
+  const bool ok = ((count == shot.second.size()) && pause(BLAST_STEP));
+
+  std::lock_guard<std::mutex> lock(Screen::getMutex());
+  screen << SaveCursor;
+  for (const Coordinate& coord : shot.second) {
+    screen << toScreenCoord(topLeft, coord);
+    snapshot.printSquare(screen, coord);
+  }
+  screen << RestoreCursor << Flush;
+  return ok;
+}
+
+} // namespace subsim
@@ -0,0 +1,83 @@
+//-----------------------------------------------------------------------------
+// Copyright (c) 2017 Shawn Chidester, All rights reserved
+//-----------------------------------------------------------------------------
+#ifndef SUBSIM_MAP_RENDERER_H
+#define SUBSIM_MAP_RENDERER_H
+
+#include "utils/Platform.h"
+#include "utils/Coordinate.h"
+#include "MapSnapshot.h"
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+
+namespace subsim
+{
+
+//-----------------------------------------------------------------------------
+// Draws map snapshots on its own thread so drawing, and the pauses between
+// animation steps, never hold up the game.  Only the newest snapshot is kept:
+// the display skips any turns that complete while a frame or animation is
+// being drawn.  Frames are drawn at most once per FRAME_INTERVAL.  Each one
+// is drawn while holding Screen::getMutex() and leaves the cursor where it
+// found it.
+//-----------------------------------------------------------------------------
+class MapRenderer {
+//-----------------------------------------------------------------------------
+public: // enums
+  enum {
+    FRAME_INTERVAL = 50, // ms
+    TORPEDO_STEP   = 100,
+    BLAST_STEP     = 250
+  };
+
+//-----------------------------------------------------------------------------
+private: // variables
+  Coordinate topLeft;
+  bool animate = false;
+  bool running = false;
+  bool stopping = false;
+  bool draining = false;
+  std::thread thread;
+  std::mutex mutex;
+  std::condition_variable wakeup;
+  std::shared_ptr<const MapSnapshot> pending;
+
+//-----------------------------------------------------------------------------
+public: // constructors
+  MapRenderer() = default;
+  MapRenderer(MapRenderer&&) = delete;
+  MapRenderer(const MapRenderer&) = delete;
+  MapRenderer& operator=(MapRenderer&&) = delete;
+  MapRenderer& operator=(const MapRenderer&) = delete;
+
+//-----------------------------------------------------------------------------
+public: // destructor
+  ~MapRenderer() { stop(); }
+
+//-----------------------------------------------------------------------------
+public: // methods
+  bool isRunning() const noexcept { return running; }
+
+  void start(const Coordinate& topLeft, const bool animate);
+  void submit(std::shared_ptr<const MapSnapshot>);
+
+  /**
+   * @brief Stop the render thread
+   * @param drain If true finish drawing and animating the newest snapshot
+   * first, otherwise stop as soon as the current frame is drawn
+   */
+  void stop(const bool drain = false);
+
+//-----------------------------------------------------------------------------
+private: // methods
+  void run();
+  void draw(const MapSnapshot&);
+  bool animateShot(const MapSnapshot&, const GameMap::TorpedoShot&);
+  bool pause(const unsigned ms);
+  std::shared_ptr<const MapSnapshot> next();
+};
+
+} // namespace subsim
+
+#endif // SUBSIM_MAP_RENDERER_H
@@ -0,0 +1,80 @@
+//-----------------------------------------------------------------------------
+// Copyright (c) 2017 Shawn Chidester, All rights reserved
+//-----------------------------------------------------------------------------
+#include "MapSnapshot.h"
+#include "Submarine.h"
+#include "utils/StringUtils.h"
+
+namespace subsim
+{
+
+//-----------------------------------------------------------------------------
+static ScreenColor shieldColor(const unsigned shieldCount) noexcept {
+  switch (shieldCount) {
+  case 0:  return BrightRed;
+  case 1:  return BrightMagenta;
+  case 2:  return BrightGreen;
+  default: return BrightWhite;
+  }
+}
+
+//-----------------------------------------------------------------------------
+MapSnapshot::MapSnapshot(const GameMap& gameMap,
+                         const unsigned turnNumber,
+                         const TorpedoShots& shots)
+  : Rectangle(gameMap),
+    turnNumber(turnNumber),
+    shots(shots)
+{
+  cells.reserve(getSize());
+  for (unsigned i = 0; i < getSize(); ++i) {
+    const Square& square = gameMap.getSquare(i);
+    Cell cell { square.getObjectCount(), 0, DefaultColor };
+    if (cell.count == 1) {
+      const Object* obj = (*square.begin());
+      cell.mapChar = static_cast<char>(obj->getMapChar());
+      if (obj->isSubmarine()) {
+        cell.color = shieldColor(
+            static_cast<const Submarine*>(obj)->getShieldCount());
+      }
+    }
+    cells.push_back(cell);
+  }
+}
+
+//-----------------------------------------------------------------------------
+void
+MapSnapshot::print(Coordinate& coord) const {
+  Screen& screen = Screen::print() << coord << "   ";
+  for (unsigned x = 1; x <= getWidth(); ++x) {
+    screen << rPad(x, 3, ' ');
+  }
+  for (unsigned y = 1; y <= getHeight(); ++y) {
+    screen << coord.south() << rPad(y, 3, ' ');
+    for (unsigned x = 1; x <= getWidth(); ++x) {
+      printSquare(screen, Coordinate(x, y));
+    }
+  }
+  screen << coord.south(2);
+}
+
+//-----------------------------------------------------------------------------
+void
+MapSnapshot::printSquare(Screen& screen, const Coordinate& coord) const {
+  ASSERT(contains(coord));
+  const Cell& cell = cells[toIndex(coord)];
+  if (cell.count > 1) {
+    screen << rPad(cell.count, 3, ' ');
+  } else if (cell.count) {
+    const std::string str = rPad(toStr(cell.mapChar), 3, ' ');
+    if (cell.color != DefaultColor) {
+      screen << cell.color << str << DefaultColor;
+    } else {
+      screen << str;
+    }
+  } else {
+    screen << "  .";
+  }
+}
+
+} // namespace subsim
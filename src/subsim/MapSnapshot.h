@@ -0,0 +1,62 @@
+//-----------------------------------------------------------------------------
+// Copyright (c) 2017 Shawn Chidester, All rights reserved
+//-----------------------------------------------------------------------------
+#ifndef SUBSIM_MAP_SNAPSHOT_H
+#define SUBSIM_MAP_SNAPSHOT_H
+
+#include "utils/Platform.h"
+#include "utils/Coordinate.h"
+#include "utils/Rectangle.h"
+#include "utils/Screen.h"
+#include "GameMap.h"
+
+namespace subsim
+{
+
+//-----------------------------------------------------------------------------
+// What the map looks like at the end of a turn, along with the torpedo shots
+// fired during that turn.  Holds no pointers into the GameMap it was taken
+// from, so once built it can be drawn on any thread while the game moves on.
+//-----------------------------------------------------------------------------
+class MapSnapshot : public Rectangle {
+//-----------------------------------------------------------------------------
+public: // typedefs
+  typedef std::vector<GameMap::TorpedoShot> TorpedoShots;
+
+//-----------------------------------------------------------------------------
+private: // types
+  struct Cell {
+    unsigned count;
+    char mapChar;
+    ScreenColor color;
+  };
+
+//-----------------------------------------------------------------------------
+private: // variables
+  unsigned turnNumber = 0;
+  std::vector<Cell> cells;
+  TorpedoShots shots;
+
+//-----------------------------------------------------------------------------
+public: // constructors
+  MapSnapshot(const GameMap&,
+              const unsigned turnNumber,
+              const TorpedoShots& shots = TorpedoShots());
+
+  MapSnapshot(MapSnapshot&&) = default;
+  MapSnapshot(const MapSnapshot&) = default;
+  MapSnapshot& operator=(MapSnapshot&&) = default;
+  MapSnapshot& operator=(const MapSnapshot&) = default;
+
+//-----------------------------------------------------------------------------
+public: // methods
+  unsigned getTurnNumber() const noexcept { return turnNumber; }
+  const TorpedoShots& shotsFired() const noexcept { return shots; }
+
+  void print(Coordinate&) const;
+  void printSquare(Screen&, const Coordinate&) const;
+};
+
+} // namespace subsim
+
+#endif // SUBSIM_MAP_SNAPSHOT_H
@@ -21,7 +21,7 @@ public: // constructors
   Mine& operator=(const Mine&) noexcept = default;
 
   Mine(const unsigned playerID, const char mapChar) noexcept
-    : Object(mapChar, playerID, ~0U, 10, false)
+    : Object(MineType, mapChar, playerID, ~0U, 10, false)
   { }
 
 //-----------------------------------------------------------------------------
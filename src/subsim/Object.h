@@ -13,8 +13,17 @@ namespace subsim
 
 //-----------------------------------------------------------------------------
 class Object : public Printable {
+//-----------------------------------------------------------------------------
+public: // enums
+  enum ObjectType : char {
+    ObstacleType,
+    MineType,
+    SubmarineType
+  };
+
 //-----------------------------------------------------------------------------
 private: // variables
+  ObjectType objectType;
   char mapChar;
   unsigned playerID;
   unsigned objectID;
@@ -30,12 +39,14 @@ public: // constructors
   Object& operator=(Object&&) noexcept = default;
   Object& operator=(const Object&) noexcept = default;
 
-  Object(const char mapChar,
+  Object(const ObjectType objectType,
+         const char mapChar,
          const unsigned playerID,
          const unsigned objectID,
          const unsigned size,
          const bool permanent) noexcept
-    : mapChar(mapChar),
+    : objectType(objectType),
+      mapChar(mapChar),
       playerID(playerID),
       objectID(objectID),
       size(size),
@@ -54,6 +65,18 @@ public: // setters
 
 //-----------------------------------------------------------------------------
 public: // getters
+  ObjectType getObjectType() const noexcept {
+    return objectType;
+  }
+
+  bool isMine() const noexcept {
+    return (objectType == MineType);
+  }
+
+  bool isSubmarine() const noexcept {
+    return (objectType == SubmarineType);
+  }
+
   unsigned getMapChar() const noexcept {
     return mapChar;
   }
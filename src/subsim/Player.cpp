@@ -3,7 +3,9 @@
 //-----------------------------------------------------------------------------
 #include "Player.h"
 #include "utils/Error.h"
+#include "utils/Logger.h"
 #include "utils/Msg.h"
+#include <cstring>
 
 namespace subsim
 {
@@ -21,6 +23,123 @@ Player::toString() const {
   return replace(socket.toString(), "Socket", "Player");
 }
 
+//-----------------------------------------------------------------------------
+bool
+Player::send(const std::string& msg) {
+  if (msg.empty() || contains(msg, '\n')) {
+    Logger::error() << (*this) << ".send(" << msg << ") invalid message";
+    return false;
+  }
+
+  struct iovec iov[2];
+  iov[0].iov_base = const_cast<char*>(msg.data());
+  iov[0].iov_len = msg.size();
+  iov[1].iov_base = const_cast<char*>("\n");
+  iov[1].iov_len = 1;
+  return write(iov, 2, false);
+}
+
+//-----------------------------------------------------------------------------
+bool
+Player::flush(const std::string& head, const std::string& tail) {
+  struct iovec iov[3];
+  iov[0].iov_base = const_cast<char*>(head.data());
+  iov[0].iov_len = head.size();
+  iov[1].iov_base = const_cast<char*>(output.data());
+  iov[1].iov_len = output.size();
+  iov[2].iov_base = const_cast<char*>(tail.data());
+  iov[2].iov_len = tail.size();
+
+  const bool ok = write(iov, 3, true);
+  output.clear();
+  return ok;
+}
+
+//-----------------------------------------------------------------------------
+bool
+Player::sendBacklog() {
+  if (backlog.empty()) {
+    return true;
+  }
+
+  struct iovec iov;
+  iov.iov_base = const_cast<char*>(backlog.data());
+  iov.iov_len = backlog.size();
+
+  size_t sent = 0;
+  if (!socket.send(&iov, 1, sent)) {
+    return false;
+  }
+  backlog.erase(0, sent);
+  return true;
+}
+
+//-----------------------------------------------------------------------------
+// Messages are written whole or not at all once they reach the backlog,
+// so a client that misses output never sees a partial line.  When a full
+// backlog is skipped the first and last buffers are still kept if keepEnds
+// is set, flush() uses that so turn boundaries are never lost.
+//-----------------------------------------------------------------------------
+bool
+Player::write(const struct iovec* iov,
+              const unsigned count,
+              const bool keepEnds)
+{
+  size_t total = 0;
+  for (unsigned i = 0; i < count; ++i) {
+    total += iov[i].iov_len;
+  }
+
+  size_t sent = 0;
+  if (backlog.empty()) {
+    if (!socket.send(iov, count, sent)) {
+      return false;
+    } else if (sent == total) {
+      return true;
+    }
+    // the rest of a partially written message must follow it
+  }
+
+  bool skip = false;
+  if (maxBacklog && ((backlog.size() + (total - sent)) > maxBacklog)) {
+    if (!skipWhenFull) {
+      Logger::warn() << (*this) << " backlog limit (" << maxBacklog
+                     << " bytes) exceeded";
+      return false;
+    }
+    LOG_DEBUG << (*this) << " backlog full, skipping output";
+    status = "lagging";
+    skip = true;
+  }
+
+  // a line that is partly written is finished even when skipping
+  bool midLine = false;
+  for (unsigned i = 0; i < count; ++i) {
+    const char* data = static_cast<const char*>(iov[i].iov_base);
+    const size_t n = std::min<size_t>(sent, iov[i].iov_len);
+    size_t size = (iov[i].iov_len - n);
+    sent -= n;
+    if (n) {
+      midLine = (data[n - 1] != '\n');
+    }
+    if (skip && !(keepEnds && ((i == 0) || ((i + 1) == count)))) {
+      if (!midLine) {
+        continue;
+      }
+      const char* eol =
+          static_cast<const char*>(memchr((data + n), '\n', size));
+      if (eol) {
+        size = (eol - (data + n) + 1);
+      }
+    }
+    if (size) {
+      backlog.append((data + n), size);
+      midLine = (data[n + size - 1] != '\n');
+    }
+  }
+  return true;
+}
+
 //-----------------------------------------------------------------------------
 std::string
 Player::summary(const bool gameStarted) const {
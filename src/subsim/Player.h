@@ -7,6 +7,7 @@
 #include "utils/Platform.h"
 #include "utils/Printable.h"
 #include "utils/Socket.h"
+#include "utils/StringUtils.h"
 #include "db/DBRecord.h"
 #include "Submarine.h"
 
@@ -22,7 +23,14 @@ private: // variables
   std::vector<SubmarinePtr> subs;
   unsigned score = 0;
   unsigned turns = 0;
+  unsigned maxBacklog = 0;   // 0 = unlimited
+  bool skipWhenFull = false; // discard output rather than fail when full
   char mapChar = '?';
+  std::string backlog;       // output the socket has not accepted yet
+
+//-----------------------------------------------------------------------------
+protected: // variables
+  std::string output; // queued messages, each terminated by a new-line
 
 //-----------------------------------------------------------------------------
 public: // constructors
@@ -45,10 +53,30 @@ public: // methods
     status = "disconnected";
   }
 
-  bool send(const std::string& msg) const {
-    return socket.send(msg);
+  // hand the connection to someone else, leaving this player disconnected
+  Socket releaseConnection() {
+    status = "moved";
+    return std::move(socket);
+  }
+
+  // never blocks, output the socket can't take now is kept in the backlog
+  // and written by sendBacklog() once the socket becomes writable
+  virtual bool send(const std::string& msg);
+
+  // buffer message for the next flush()
+  void queue(const std::string& msg) {
+    ASSERT(msg.size() && !contains(msg, '\n'));
+    output += msg;
+    output += '\n';
   }
 
+  // send head, then queued messages, then tail in one write,
+  // head and tail are new-line terminated messages shared by all players
+  virtual bool flush(const std::string& head, const std::string& tail);
+
+  // write as much of the backlog as the socket will take
+  bool sendBacklog();
+
   std::string summary(const bool gameStarted) const;
   void setMapChar(const char ch);
   void stealConnectionFrom(Player&);
@@ -63,6 +91,14 @@ public: // setters
     socket.setLabel(value);
   }
 
+  // limit backlog to the given number of bytes, when the limit is reached
+  // further output either fails (disconnect) or is discarded (skip), the
+  // shared messages that open and close a turn are never discarded
+  void setBacklogLimit(const unsigned bytes, const bool skip) noexcept {
+    maxBacklog = bytes;
+    skipWhenFull = skip;
+  }
+
   void setStatus(const std::string& value) {
     status = value;
   }
@@ -101,14 +137,22 @@ public: // getters
     return status;
   }
 
-  bool isConnected() const noexcept {
+  virtual bool isConnected() const noexcept {
     return socket.isOpen();
   }
 
-  int handle() const noexcept {
+  virtual int handle() const noexcept {
     return socket.getHandle();
   }
 
+  bool hasBacklog() const noexcept {
+    return backlog.size();
+  }
+
+  unsigned getBacklogSize() const noexcept {
+    return backlog.size();
+  }
+
   unsigned getScore() const noexcept {
     return score;
   }
@@ -132,6 +176,10 @@ public: // getters
   Submarine& getSubmarine(const unsigned subID) {
     return (*subs[subID]);
   }
+
+//-----------------------------------------------------------------------------
+private: // methods
+  bool write(const struct iovec*, const unsigned count, const bool keepEnds);
 };
 
 //-----------------------------------------------------------------------------
@@ -0,0 +1,385 @@
+//-----------------------------------------------------------------------------
+// Copyright (c) 2017 Shawn Chidester, All rights reserved
+//-----------------------------------------------------------------------------
+#include "Replay.h"
+#include "utils/CSVReader.h"
+#include "utils/Error.h"
+#include "utils/Msg.h"
+#include "utils/StringUtils.h"
+#include "commands/FireCommand.h"
+#include "commands/MineCommand.h"
+#include "commands/MoveCommand.h"
+#include "commands/PingCommand.h"
+#include "commands/SleepCommand.h"
+#include "commands/SprintCommand.h"
+#include "commands/SurfaceCommand.h"
+#include <cstring>
+
+namespace subsim
+{
+
+//-----------------------------------------------------------------------------
+static const std::string NEW_GAME("NEW_GAME: ");
+static const std::string SEED("SEED: ");
+static const std::string SERVER_ALL("SERVER ALL: ");
+static const std::string SERVER("SERVER ");
+static const std::string PLAYER("PLAYER ");
+static const std::string REMOVED("REMOVED: ");
+static const std::string NAME_END(": ");
+
+//-----------------------------------------------------------------------------
+// Split a "SERVER name: msg" or "PLAYER name: msg" line
+//-----------------------------------------------------------------------------
+static bool splitLine(const std::string& line,
+                      const std::string& prefix,
+                      std::string& name,
+                      std::string& message)
+{
+  const std::size_t pos = line.find(NAME_END, prefix.size());
+  if (!startsWith(line, prefix) || (pos == std::string::npos)) {
+    return false;
+  }
+  name = line.substr(prefix.size(), (pos - prefix.size()));
+  message = line.substr(pos + NAME_END.size());
+  return true;
+}
+
+//-----------------------------------------------------------------------------
+// The server version in the NEW_GAME line is not part of the game
+//-----------------------------------------------------------------------------
+static std::string withoutVersion(const std::string& line) {
+  const std::size_t pos = line.find('|', (NEW_GAME.size() + 2));
+  return (pos == std::string::npos) ? line : line.substr(pos);
+}
+
+//-----------------------------------------------------------------------------
+static Direction toDirection(const std::string& str) {
+  if (str == "N") {
+    return North;
+  } else if (str == "E") {
+    return East;
+  } else if (str == "S") {
+    return South;
+  } else if (str == "W") {
+    return West;
+  }
+  throw Error("Invalid direction: " + str);
+}
+
+//-----------------------------------------------------------------------------
+// Parse a command the way it was logged by Command::toString()
+//-----------------------------------------------------------------------------
+static Command toCommand(const unsigned playerID, const std::string& message) {
+  std::vector<std::string> fields = CSVReader(message, '|').readCells();
+  if ((fields.size() < 3) || (fields[0].size() != 1)) {
+    throw Error(Msg() << "Invalid command: " << message);
+  }
+
+  const unsigned turn = toUInt32(fields[1]);
+  const unsigned subID = toUInt32(fields[2]);
+  const std::size_t count = fields.size();
+  switch (fields[0][0]) {
+  case SleepCommand::TYPE:
+    if (count == 5) {
+      return SleepCommand(playerID, turn, subID,
+                          Submarine::getEquipment(fields[3]),
+                          Submarine::getEquipment(fields[4]));
+    }
+    break;
+  case MoveCommand::TYPE:
+    if (count == 5) {
+      return MoveCommand(playerID, turn, subID, toDirection(fields[3]),
+                         Submarine::getEquipment(fields[4]));
+    }
+    break;
+  case SprintCommand::TYPE:
+    if (count == 5) {
+      return SprintCommand(playerID, turn, subID, toDirection(fields[3]),
+                           toUInt32(fields[4]));
+    }
+    break;
+  case MineCommand::TYPE:
+    if (count == 4) {
+      return MineCommand(playerID, turn, subID, toDirection(fields[3]));
+    }
+    break;
+  case FireCommand::TYPE:
+    if (count == 5) {
+      return FireCommand(playerID, turn, subID,
+                         Coordinate(toUInt32(fields[3]), toUInt32(fields[4])));
+    }
+    break;
+  case SurfaceCommand::TYPE:
+    if (count == 3) {
+      return SurfaceCommand(playerID, turn, subID);
+    }
+    break;
+  case PingCommand::TYPE:
+    if (count == 3) {
+      return PingCommand(playerID, turn, subID);
+    }
+    break;
+  }
+  throw Error(Msg() << "Invalid command: " << message);
+}
+
+//-----------------------------------------------------------------------------
+Replay::Checker::int_type
+Replay::Checker::overflow(int_type ch) {
+  if (!traits_type::eq_int_type(ch, traits_type::eof())) {
+    if (traits_type::to_char_type(ch) == '\n') {
+      replay.check(line);
+      line.clear();
+    } else {
+      line += traits_type::to_char_type(ch);
+    }
+  }
+  return traits_type::not_eof(ch);
+}
+
+//-----------------------------------------------------------------------------
+std::streamsize
+Replay::Checker::xsputn(const char* data, std::streamsize count) {
+  const char* end = (data + count);
+  for (const char* p = data; p < end; ) {
+    const char* eol = static_cast<const char*>(memchr(p, '\n', (end - p)));
+    if (!eol) {
+      line.append(p, (end - p));
+      break;
+    }
+    line.append(p, (eol - p));
+    replay.check(line);
+    line.clear();
+    p = (eol + 1);
+  }
+  return count;
+}
+
+//-----------------------------------------------------------------------------
+std::string
+Replay::run(const std::vector<std::string>& gameLines) {
+  lines = &gameLines;
+  next = 0;
+  error.clear();
+  handles.clear();
+
+  try {
+    setup();
+    while (error.empty() && !sim.isFinished() && playTurn()) { }
+    if (error.empty()) {
+      finish();
+    }
+    while ((next < lines->size()) && isInput((*lines)[next])) {
+      next++;
+    }
+    if (error.empty() && (next < lines->size())) {
+      fail("recorded line not repeated: " + (*lines)[next]);
+    }
+  } catch (const std::exception& e) {
+    fail(e.what());
+  }
+
+  lines = nullptr;
+  return error;
+}
+
+//-----------------------------------------------------------------------------
+// Lines the server writes about a game that the game doesn't write itself
+//-----------------------------------------------------------------------------
+bool
+Replay::isInput(const std::string& line) const {
+  return startsWith(line, REMOVED);
+}
+
+//-----------------------------------------------------------------------------
+// Compare a line written by the game to the next recorded line
+//-----------------------------------------------------------------------------
+void
+Replay::check(const std::string& line) {
+  if (error.size() || !lines) {
+    return;
+  }
+
+  while ((next < lines->size()) && isInput((*lines)[next])) {
+    next++;
+  }
+  if (next >= lines->size()) {
+    fail("replay continued past the end of the log: " + line);
+    return;
+  }
+
+  const std::string& recorded = (*lines)[next];
+  if ((line != recorded) &&
+      !(startsWith(line, NEW_GAME) && startsWith(recorded, NEW_GAME) &&
+        (withoutVersion(line) == withoutVersion(recorded))))
+  {
+    fail("expected '" + recorded + "', replay wrote '" + line + "'");
+    return;
+  }
+  next++;
+}
+
+//-----------------------------------------------------------------------------
+void
+Replay::fail(const std::string& message) {
+  if (error.empty()) {
+    error = (Msg() << "line " << (next + 1) << ", turn "
+             << sim.getTurnNumber() << ": " << message);
+  }
+}
+
+//-----------------------------------------------------------------------------
+// Start the game from the config, seed and positions in the log header
+//-----------------------------------------------------------------------------
+void
+Replay::setup() {
+  GameConfig config;
+  std::string title;
+  uint64_t seed = 0;
+  bool seeded = false;
+  std::vector<std::string> names;
+  std::map<std::string, std::vector<Coordinate>> positions;
+  std::string name;
+  std::string message;
+
+  for (const std::string& line : (*lines)) {
+    if (startsWith(line, SERVER_ALL)) {
+      message = line.substr(SERVER_ALL.size());
+      if (startsWith(message, "B|")) {
+        break;
+      } else if (startsWith(message, "V|")) {
+        config.addSetting(GameSetting::fromMessage(message));
+      } else if (startsWith(message, "J|")) {
+        names.push_back(message.substr(2));
+      }
+    } else if (startsWith(line, NEW_GAME)) {
+      std::vector<std::string> fields =
+          CSVReader(line.substr(NEW_GAME.size()), '|').readCells();
+      if ((fields.size() < 3) || (fields[0] != "C")) {
+        throw Error(Msg() << "Invalid game config: " << line);
+      }
+      title = fields[2];
+    } else if (startsWith(line, SEED)) {
+      seed = toUInt64(line.substr(SEED.size()));
+      seeded = true;
+    } else if (splitLine(line, SERVER, name, message) &&
+               startsWith(message, "I|"))
+    {
+      // I|player|sub|x|y|...
+      std::vector<std::string> fields = CSVReader(message, '|').readCells();
+      if (fields.size() < 5) {
+        throw Error(Msg() << "Invalid sub info: " << line);
+      }
+      const unsigned subID = toUInt32(fields[2]);
+      std::vector<Coordinate>& coords = positions[name];
+      if (coords.size() <= subID) {
+        coords.resize(subID + 1);
+      }
+      coords[subID].set(toUInt32(fields[3]), toUInt32(fields[4]));
+    }
+  }
+
+  if (title.empty()) {
+    throw Error("Game log has no NEW_GAME line");
+  } else if (!seeded) {
+    throw Error("Game log has no SEED line");
+  }
+
+  sim.reset(config, title, seed, gameLog);
+  for (const std::string& player : names) {
+    handles[player] = sim.addPlayer(player, positions[player])->handle();
+  }
+  sim.start();
+  for (const SimPlayerPtr& player : sim.getPlayers()) {
+    player->clearMessages();
+  }
+}
+
+//-----------------------------------------------------------------------------
+// Apply the recorded removals and commands of the next turn and execute it,
+// false if the log has no more turns
+//-----------------------------------------------------------------------------
+bool
+Replay::playTurn() {
+  std::vector<Command> commands;
+  std::string name;
+  std::string message;
+  std::size_t i = next;
+
+  for (; i < lines->size(); ++i) {
+    const std::string& line = (*lines)[i];
+    if (isInput(line)) {
+      const std::size_t sep = line.find('|', REMOVED.size());
+      name = line.substr(REMOVED.size(), (sep - REMOVED.size()));
+      sim.removePlayer(name, ((sep == std::string::npos) ? ""
+                                                         : line.substr(sep + 1)));
+    } else if (splitLine(line, PLAYER, name, message)) {
+      auto it = handles.find(name);
+      if (it == handles.end()) {
+        fail("command from unknown player: " + line);
+        return false;
+      }
+      commands.push_back(toCommand(static_cast<unsigned>(it->second),
+                                   message));
+    } else {
+      break;
+    }
+  }
+
+  if (sim.isFinished() || (commands.empty() &&
+      ((i >= lines->size()) || startsWith((*lines)[i], "SERVER ALL: F|"))))
+  {
+    return false;
+  }
+
+  for (const Command& command : commands) {
+    if (!sim.addCommand(command)) {
+      fail("recorded command rejected: " + command.toString());
+      return false;
+    }
+  }
+
+  sim.executeTurn();
+  for (const SimPlayerPtr& player : sim.getPlayers()) {
+    player->clearMessages();
+  }
+  return error.empty();
+}
+
+//-----------------------------------------------------------------------------
+// Write the results the server writes when the game ends
+//-----------------------------------------------------------------------------
+void
+Replay::finish() {
+  while ((next < lines->size()) && isInput((*lines)[next])) {
+    next++;
+  }
+  if (next >= lines->size()) {
+    return; // the server stopped before the game ended
+  }
+
+  const std::string& line = (*lines)[next];
+  if (!startsWith(line, "SERVER ALL: F|")) {
+    fail("recorded line not repeated: " + line);
+    return;
+  }
+
+  if (!sim.isFinished()) {
+    if (line.size() > 8 && !line.compare(line.size() - 8, 8, "|aborted")) {
+      sim.abort();
+    } else {
+      sim.finish();
+    }
+  }
+
+  const Game& game = sim.getGame();
+  gameLog << SERVER_ALL
+          << (Msg('F') << game.getPlayerCount() << game.getTurnNumber()
+              << (game.isAborted() ? "aborted" : "finished")) << '\n';
+  for (const PlayerPtr& player : game.getPlayers()) {
+    gameLog << SERVER_ALL
+            << (Msg('P') << player->getName() << player->getScore()) << '\n';
+  }
+}
+
+} // namespace subsim
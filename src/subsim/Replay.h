@@ -0,0 +1,79 @@
+//-----------------------------------------------------------------------------
+// Copyright (c) 2017 Shawn Chidester, All rights reserved
+//-----------------------------------------------------------------------------
+#ifndef SUBSIM_REPLAY_H
+#define SUBSIM_REPLAY_H
+
+#include "utils/Platform.h"
+#include "Simulation.h"
+#include <ostream>
+
+namespace subsim
+{
+
+//-----------------------------------------------------------------------------
+// Re-runs a recorded game from its game log lines.  The config, seed,
+// starting positions, player commands and removals are read from the log
+// and fed to a Simulation, and every line the game writes to its own log
+// is checked against the recorded line as it is written, so a replay stops
+// at the first turn where the engine no longer does what it did.
+//-----------------------------------------------------------------------------
+class Replay {
+//-----------------------------------------------------------------------------
+private: // types
+  class Checker : public std::streambuf {
+    Replay& replay;
+    std::string line;
+
+  public:
+    explicit Checker(Replay& replay) noexcept : replay(replay) { }
+
+  protected:
+    int_type overflow(int_type ch) override;
+    std::streamsize xsputn(const char* data, std::streamsize count) override;
+  };
+
+//-----------------------------------------------------------------------------
+private: // variables
+  Checker checker;
+  std::ostream gameLog{&checker};
+  Simulation sim;
+  const std::vector<std::string>* lines = nullptr;
+  std::size_t next = 0; // index of the next recorded line to check
+  std::string error;    // first difference found
+  std::map<std::string, int> handles;
+
+//-----------------------------------------------------------------------------
+public: // constructors
+  Replay() : checker(*this) { }
+  Replay(Replay&&) = delete;
+  Replay(const Replay&) = delete;
+  Replay& operator=(Replay&&) = delete;
+  Replay& operator=(const Replay&) = delete;
+
+//-----------------------------------------------------------------------------
+public: // methods
+  const Game& getGame() const noexcept { return sim.getGame(); }
+
+  /**
+   * @brief Replay one recorded game
+   * @param gameLines The game's log lines, from its NEW_GAME line up to
+   *        (not including) the next game's NEW_GAME line
+   * @return empty if the replay matched the log, otherwise a description
+   *         of the first difference
+   */
+  std::string run(const std::vector<std::string>& gameLines);
+
+//-----------------------------------------------------------------------------
+private: // methods
+  bool isInput(const std::string& line) const;
+  void check(const std::string& line);
+  void fail(const std::string& message);
+  void setup();
+  void finish();
+  bool playTurn();
+};
+
+} // namespace subsim
+
+#endif // SUBSIM_REPLAY_H
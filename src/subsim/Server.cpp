@@ -12,12 +12,14 @@
 #include "utils/StringUtils.h"
 #include "db/FileSysDatabase.h"
 #include "db/FileSysDBRecord.h"
+#include "Lobby.h"
+#include <fcntl.h>
+#include <iostream>
 
 namespace subsim
 {
 
 //-----------------------------------------------------------------------------
-const Version SERVER_VERSION("1.0.x");
 const std::string ADDRESS_PREFIX("Adress: ");
 const std::string BOOTED("booted");
 const std::string COMM_ERROR("comm error");
@@ -31,10 +33,27 @@ const std::string PROTOCOL_ERROR("protocol error");
 const std::string INVALID_SUBS("invalid sub data");
 const unsigned MAX_PLAYER_NAME_SIZE = 12;
 
+//-----------------------------------------------------------------------------
+static std::mutex dbMutex; // lobby rooms share the stats database
+
+//-----------------------------------------------------------------------------
+Server::Server(Lobby& lobby, const unsigned roomNumber, const std::string& title)
+  : autoStart(true),
+    controlHandle(-1),
+    lobby(&lobby),
+    roomNumber(roomNumber),
+    roomTitle(title)
+{
+  setBacklogOptions();
+  wakeup.open();
+  input.addHandle(wakeup.getReadHandle(), ("room " + toStr(roomNumber)));
+  openGameLog('.' + toStr(roomNumber));
+}
+
 //-----------------------------------------------------------------------------
 Version
 Server::getVersion() {
-  return SERVER_VERSION;
+  return GameConfig::getServerVersion();
 }
 
 //-----------------------------------------------------------------------------
@@ -58,14 +77,37 @@ Server::showHelp() {
       << "  -t, --title <title>       Set game title to given value" << EL
       << "  -c, --config <file>       Use given GameConfig file" << EL
       << "  -o, --opt <opt>           Set the given game option" << EL
+      << "  --seed <value>            Set random number seed (default=random)" << EL
       << EL
       << "SERVER OPTIONS:" << EL
       << "  -a, --auto-start          Auto start game if max players joined" << EL
       << "  -r, --repeat              Repeat game when done" << EL
       << "  --animate                 Enable animations in map display" << EL
+      << "  --headless                Run without terminal display, see below" << EL
+      << "  --control <path>          Read headless admin commands from <path>" << EL
+      << "  --lobby <rooms>           Host <rooms> games at once, see below" << EL
+      << "  --max-backlog <bytes>     Max unsent bytes per player (0=no limit)" << EL
+      << "  --slow-client <policy>    When max backlog reached: disconnect, skip" << EL
+      << "  -g, --game-log <file>     Append game transcripts to given file" << EL
+      << "  --game-log-sync           Put each turn on disk before sending it" << EL
+      << "  --game-log-binary         Write a compact binary game log, use" << EL
+      << "                            subsim-log to convert it back to text" << EL
       << EL
       << "DATABASE OPTIONS:" << EL
       << "  -d, --db-dir <dir>        Save game stats to given directory" << EL
+      << EL
+      << "LOBBY MODE:" << EL
+      << "  Each room plays its own game on its own thread, with its own game" << EL
+      << "  log (<game-log>.<room>).  Rooms are titled '<title> <room>' and start" << EL
+      << "  as soon as enough players join, repeating until the server is quit." << EL
+      << "  New connections are sent to the first room with an open seat, a" << EL
+      << "  client may send G|<title> instead of J to move to another room." << EL
+      << EL
+      << "HEADLESS MODE:" << EL
+      << "  Nothing is drawn and --title is required.  Admin commands are read" << EL
+      << "  one per line from stdin, or from the FIFO given by --control:" << EL
+      << "  status, start, boot|<player>, ban|<player>, banaddr|<address>," << EL
+      << "  clear (the blacklist), quit.  Status lines are written to stdout." << EL
       << EL << Flush;
 }
 
@@ -74,8 +116,14 @@ bool
 Server::init() {
   const CommandArgs& args = CommandArgs::getInstance();
 
-  Screen::get() << args.getProgramName() << " version " << getVersion()
-                << EL << Flush;
+  // Screen needs a terminal, a headless server may not have one
+  headless = args.has("--headless");
+  if (headless) {
+    report(args.getProgramName() + " version " + getVersion().toString());
+  } else {
+    Screen::get() << args.getProgramName() << " version " << getVersion()
+                  << EL << Flush;
+  }
 
   if (args.has("--help")) {
     showHelp();
@@ -84,18 +132,85 @@ Server::init() {
 
   autoStart = args.has({"-a", "--auto-start"});
   repeat    = args.has({"-r", "--repeat"});
-  animate   = args.has("--animate");
+  animate   = (args.has("--animate") && !headless);
+  setBacklogOptions();
+
+  if (headless) {
+    openControl(args.getStrAfter("--control"));
+  }
+
+  // lobby rooms open their own <game-log>.<room> files
+  if (!args.has("--lobby")) {
+    openGameLog("");
+  }
+  return true;
+}
+
+//-----------------------------------------------------------------------------
+void
+Server::setBacklogOptions() {
+  const CommandArgs& args = CommandArgs::getInstance();
+  maxBacklog = args.getUIntAfter("--max-backlog", DEFAULT_MAX_BACKLOG);
+  const std::string policy = args.getStrAfter("--slow-client");
+  if (isEmpty(policy) || iEqual(policy, "disconnect")) {
+    skipSlowClients = false;
+  } else if (iEqual(policy, "skip")) {
+    skipSlowClients = true;
+  } else {
+    throw Error(Msg() << "Invalid --slow-client policy: " << policy);
+  }
+}
 
+//-----------------------------------------------------------------------------
+// A FIFO is opened read/write so the server never sees end of file when the
+// last writer goes away, the next writer picks up where it left off.  It is
+// non-blocking like player connections, a half written command must not hold
+// up the turn timer.
+//-----------------------------------------------------------------------------
+void
+Server::openControl(const std::string& path) {
+  if (isEmpty(path)) {
+    return; // stdin
+  }
+
+  const int fd = ::open(path.c_str(), (O_RDWR | O_CLOEXEC | O_NONBLOCK));
+  if (fd < 0) {
+    throw Error(Msg() << "Failed to open control channel '" << path << "': "
+                << toError(errno));
+  }
+
+  closeControl();
+  controlHandle = fd;
+  input.addHandle(controlHandle, "control");
+}
+
+//-----------------------------------------------------------------------------
+void
+Server::closeControl() {
+  if (controlHandle >= 0) {
+    input.removeHandle(controlHandle);
+    if (controlHandle != STDIN_FILENO) {
+      ::close(controlHandle);
+    }
+    controlHandle = -1;
+  }
+}
+
+//-----------------------------------------------------------------------------
+void
+Server::openGameLog(const std::string& suffix) {
+  const CommandArgs& args = CommandArgs::getInstance();
   std::string fname = args.getStrAfter({"-g", "--game-log"});
   if (isEmpty(fname)) {
     fname = (args.getProgram() + ".gamelog");
   }
-  gameLog.open(fname, (std::ios_base::out | std::ios_base::app));
-  if (!gameLog) {
+  fname += suffix;
+  const bool sync = args.has("--game-log-sync");
+  if (args.has("--game-log-binary") ? !binaryLog.open(fname, sync)
+                                    : !textLog.open(fname, sync))
+  {
     throw Error(Msg() << "Failed to open '" << fname << "' for output");
   }
-
-  return true;
 }
 
 //-----------------------------------------------------------------------------
@@ -104,6 +219,8 @@ Server::run() {
   std::string title;
   if (!getGameTitle(title)) {
     return false;
+  } else if (headless) {
+    return runHeadless(title);
   }
 
   bool ok = true;
@@ -111,28 +228,79 @@ Server::run() {
     CanonicalMode cmode(false);
     UNUSED(cmode);
 
-    game.reset(newGameConfig(), title);
+    game.reset(newGameConfig(), title, newGameSeed());
     startListening();
 
+    // the map is drawn by the renderer thread, see printMap()
     Coordinate coord;
+    renderedTurn = NO_TURN;
     while (ok && !game.isFinished()) {
-      if (game.isStarted()) {
-        printMap(coord.set(1, 1));
-      } else {
-        printGameInfo(coord.set(1, 1));
+      {
+        std::lock_guard<std::mutex> lock(Screen::getMutex());
+        if (game.isStarted()) {
+          printMap(coord.set(1, 1));
+        } else {
+          printGameInfo(coord.set(1, 1));
+        }
+        printPlayers(coord);
+        printOptions(coord);
       }
-      printPlayers(coord);
-      printOptions(coord);
       if (waitForInput()) {
+        std::lock_guard<std::mutex> lock(Screen::getMutex());
         ok = handleUserInput(coord);
       }
     }
-    if (ok && animate) {
+
+    // the turn number doesn't advance after the final turn
+    const bool showLastTurn = (ok && animate);
+    if (showLastTurn) {
+      renderedTurn = NO_TURN;
       printMap(coord.set(1, 1));
     }
 
+    if (game.isAborted()) {
+      sendGameResults();
+      ok = true; // allow restart
+    } else if (game.isFinished()) {
+      sendGameResults();
+      saveResult();
+    }
+
+    // results are out, nobody waits while the last turn is animated
+    renderer.stop(showLastTurn);
     printGameInfo(coord.set(1, 1));
     printPlayers(coord);
+  }
+  catch (const std::exception& e) {
+    Logger::printError() << e.what();
+    ok = false;
+  }
+
+  renderer.stop();
+  Screen::get(true) << EL << DefaultColor << Flush;
+  close();
+  return ok;
+}
+
+//-----------------------------------------------------------------------------
+// Same game loop as run() with nothing drawn, the loop only wakes for
+// connections, player input, turn deadlines and admin commands
+//-----------------------------------------------------------------------------
+bool
+Server::runHeadless(const std::string& title) {
+  bool ok = true;
+  try {
+    game.reset(newGameConfig(), title, newGameSeed());
+    startListening();
+    report(Msg() << "Game '" << title << "' waiting for players on "
+           << socket.getAddress() << ':' << socket.getPort());
+
+    while (ok && !game.isFinished()) {
+      if (waitForInput()) {
+        ok = handleControlInput();
+      }
+    }
+
     if (game.isAborted()) {
       sendGameResults();
       ok = true; // allow restart
@@ -140,13 +308,18 @@ Server::run() {
       sendGameResults();
       saveResult();
     }
+    if (game.isFinished()) {
+      report(Msg() << "Game '" << title << "' "
+             << (game.isAborted() ? "aborted" : "over") << " after "
+             << game.getTurnNumber() << " turns");
+      reportStatus();
+    }
   }
   catch (const std::exception& e) {
     Logger::printError() << e.what();
     ok = false;
   }
 
-  Screen::get(true) << EL << DefaultColor << Flush;
   close();
   return ok;
 }
@@ -161,7 +334,9 @@ Server::prompt(Coordinate coord,
   UNUSED(cmode);
 
   Screen::print() << coord << ClearToLineEnd << question << Flush;
-  return input.readln(STDIN_FILENO, delim) ? input.getStr() : std::string();
+  const unsigned count = input.readln(STDIN_FILENO, delim);
+  Screen::print().invalidate(); // the answer was echoed
+  return count ? input.getStr() : std::string();
 }
 
 //-----------------------------------------------------------------------------
@@ -188,10 +363,30 @@ GameConfig Server::newGameConfig() {
   return std::move(config);
 }
 
+//-----------------------------------------------------------------------------
+uint64_t
+Server::newGameSeed() {
+  const std::string seed = CommandArgs::getInstance().getStrAfter("--seed");
+  if (seed.size()) {
+    return toUInt64(seed);
+  }
+  // rooms starting in the same second must not play the same game
+  return (Random::newSeed() + (roomNumber * 0x9E3779B97F4A7C15ULL));
+}
+
 //-----------------------------------------------------------------------------
 bool
 Server::getGameTitle(std::string& title) {
   title = CommandArgs::getInstance().getStrAfter({"-t", "--title"});
+  if (headless) {
+    if (isEmpty(title) || contains(title, '|') || (title.size() > 20)) {
+      Logger::printError() << "--headless requires a --title of at most 20 "
+                           << "characters, without '|' characters";
+      return false;
+    }
+    return true;
+  }
+
   do {
     if (isEmpty(title)) {
       Screen::print() << "Enter game title [RET=quit] -> " << Flush;
@@ -217,6 +412,19 @@ Server::getGameTitle(std::string& title) {
   return true;
 }
 
+//-----------------------------------------------------------------------------
+PlayerPtr
+Server::findPlayer(const std::string& nameOrNumber) const {
+  PlayerPtr player;
+  if (nameOrNumber.size()) {
+    player = game.getPlayer(nameOrNumber);
+    if (!player) {
+      player = game.getPlayer(toInt32(nameOrNumber, -1));
+    }
+  }
+  return player;
+}
+
 //-----------------------------------------------------------------------------
 bool
 Server::isServerHandle(const int handle) const {
@@ -226,7 +434,7 @@ Server::isServerHandle(const int handle) const {
 //-----------------------------------------------------------------------------
 bool
 Server::isUserHandle(const int handle) const {
-  return ((handle >= 0) && (handle == STDIN_FILENO));
+  return ((handle >= 0) && (handle == controlHandle));
 }
 
 //-----------------------------------------------------------------------------
@@ -275,31 +483,54 @@ Server::send(Player& recipient, const std::string& msg,
 //-----------------------------------------------------------------------------
 bool
 Server::waitForInput(const int timeout) {
-  // TODO handle turn timeout
+  // don't sleep past the next turn deadline, the handlers below never block
+  // (a partial line is left buffered) so the deadline is checked on time
+  int wait = timers.nextTimeout();
+  if ((wait < 0) || ((timeout >= 0) && (timeout < wait))) {
+    wait = timeout;
+  }
+
   std::set<int> ready;
-  if (!input.waitForData(ready, timeout)) {
+  std::set<int> writable;
+  watchBacklogs();
+  Logger::getInstance().flush();
+  if (!input.waitForData(ready, writable, wait)) {
+    expireTimers();
     return false;
   }
 
+  for (const int handle : writable) {
+    handlePlayerOutput(handle);
+  }
+
   bool userInput = false;
   for (const int handle : ready) {
     if (isServerHandle(handle)) {
       addPlayerHandle();
+    } else if (lobby && (handle == wakeup.getReadHandle())) {
+      takeHandoffs();
     } else if (isUserHandle(handle)) {
       userInput = true;
-    } else {
+    } else if (input.containsHandle(handle)) {
       handlePlayerInput(handle);
     }
   }
+  expireTimers();
   return userInput;
 }
 
 //-----------------------------------------------------------------------------
 void
 Server::addPlayerHandle() {
-  PlayerPtr player = std::make_shared<Player>("new", socket.accept());
+  addConnection(socket.accept());
+}
+
+//-----------------------------------------------------------------------------
+void
+Server::addConnection(Socket&& connection) {
+  PlayerPtr player = std::make_shared<Player>("new", std::move(connection));
   if (!player->isConnected()) {
-    Logger::debug() << "no new connetion from accept"; // not an error
+    LOG_DEBUG << "no new connetion from accept"; // not an error
     return;
   }
 
@@ -308,10 +539,11 @@ Server::addPlayerHandle() {
   }
 
   if (blackList.count(ADDRESS_PREFIX + player->getAddress())) {
-    Logger::debug() << (*player) << " address is blacklisted";
+    LOG_DEBUG << (*player) << " address is blacklisted";
     return;
   }
 
+  player->setBacklogLimit(maxBacklog, skipSlowClients);
   if (sendGameInfo(*player)) {
     input.addHandle(player->handle(), player->getAddress());
     stagedPlayers[player->handle()] = player;
@@ -324,32 +556,41 @@ Server::beginGame() {
   stopListening();
 
   const GameConfig& config = game.getConfig();
-  gameLog << "NEW_GAME: " << config.toMessage(getVersion(), game.getTitle())
-          << std::endl;
+  gameLog() << "NEW_GAME: "
+            << config.toMessage(getVersion(), game.getTitle()) << '\n';
 
   for (const GameSetting& setting : config.getCustomSettings()) {
-    gameLog << "SERVER ALL: " << setting.toMessage() << std::endl;
+    gameLog() << "SERVER ALL: " << setting.toMessage() << '\n';
   }
 
   char ch = 'A';
-  for (PlayerPtr& player : game.getPlayers()) {
+  for (const PlayerPtr& player : game.getPlayers()) {
     player->setMapChar(ch++);
-    gameLog << "SERVER ALL: J|" << player->getName() << std::endl;
+    gameLog() << "SERVER ALL: J|" << player->getName() << '\n';
   }
 
-  std::map<unsigned, std::string> errs = game.start(gameLog);
+  std::map<unsigned, std::string> errs = game.start(gameLog());
   for (auto it = errs.begin(); it != errs.end(); ++it) {
     removePlayer(static_cast<int>(it->first), it->second);
   }
+  startTurnTimer();
+
+  report(Msg() << "Game '" << game.getTitle() << "' started with "
+         << game.getPlayerCount() << " players");
 }
 
 //-----------------------------------------------------------------------------
 void
 Server::blacklistAddress(Coordinate coord) {
-  std::string str = prompt(coord, "Enter IP address to blacklist -> ");
-  if (str.size()) {
-    blackList.insert(ADDRESS_PREFIX + str);
-    for (auto& player : game.playersFromAddress(str)) {
+  blacklistAddress(prompt(coord, "Enter IP address to blacklist -> "));
+}
+
+//-----------------------------------------------------------------------------
+void
+Server::blacklistAddress(const std::string& address) {
+  if (address.size()) {
+    blackList.insert(ADDRESS_PREFIX + address);
+    for (auto& player : game.playersFromAddress(address)) {
       removePlayer(*player);
     }
   }
@@ -358,41 +599,36 @@ Server::blacklistAddress(Coordinate coord) {
 //-----------------------------------------------------------------------------
 void
 Server::blacklistPlayer(Coordinate coord) {
-  if (!game.getPlayerCount()) {
-    return;
+  if (game.getPlayerCount()) {
+    blacklistPlayer(
+        prompt(coord, "Enter name or number of player to blacklist -> "));
   }
+}
 
-  std::string name;
-  name = prompt(coord, "Enter name or number of player to blacklist -> ");
-  if (name.size()) {
-    PlayerPtr player = game.getPlayer(name);
-    if (!player) {
-      player = game.getPlayer(toInt32(name, -1));
-    }
-    if (player) {
-      blackList.insert(PLAYER_PREFIX + player->getName());
-      removePlayer(*player);
-    }
+//-----------------------------------------------------------------------------
+void
+Server::blacklistPlayer(const std::string& nameOrNumber) {
+  PlayerPtr player = findPlayer(nameOrNumber);
+  if (player) {
+    blackList.insert(PLAYER_PREFIX + player->getName());
+    removePlayer(*player);
   }
 }
 
 //-----------------------------------------------------------------------------
 void
 Server::bootPlayer(Coordinate coord) {
-  if (!game.getPlayerCount()) {
-    return;
+  if (game.getPlayerCount()) {
+    bootPlayer(prompt(coord, "Enter name or number of player to boot -> "));
   }
+}
 
-  std::string name;
-  name = prompt(coord, "Enter name or number of player to boot -> ");
-  if (name.size()) {
-    PlayerPtr player = game.getPlayer(name);
-    if (!player) {
-      player = game.getPlayer(toInt32(name, -1));
-    }
-    if (player) {
-      removePlayer((*player), BOOTED);
-    }
+//-----------------------------------------------------------------------------
+void
+Server::bootPlayer(const std::string& nameOrNumber) {
+  PlayerPtr player = findPlayer(nameOrNumber);
+  if (player) {
+    removePlayer((*player), BOOTED);
   }
 }
 
@@ -419,6 +655,7 @@ Server::clearBlacklist(Coordinate coord) {
 void
 Server::clearScreen() {
   Screen::get(true).clear().flush();
+  renderedTurn = NO_TURN;
 }
 
 //-----------------------------------------------------------------------------
@@ -437,32 +674,128 @@ Server::close() {
   stopListening();
 }
 
+//-----------------------------------------------------------------------------
+void
+Server::executeTurn() {
+  std::map<unsigned, std::string> errs = game.executeTurn(gameLog());
+  for (auto it = errs.begin(); it != errs.end(); ++it) {
+    removePlayer(static_cast<int>(it->first), it->second);
+  }
+  startTurnTimer();
+}
+
+//-----------------------------------------------------------------------------
+// When the turn deadline passes the turn is executed with whatever commands
+// have arrived, subs that weren't given orders in time sleep
+//-----------------------------------------------------------------------------
+void
+Server::expireTimers() {
+  timers.expire(expiredTimers);
+  for (const TimerWheel::TimerID id : expiredTimers) {
+    if ((id == turnTimer) && game.isStarted() && !game.isFinished()) {
+      turnTimer = TimerWheel::NO_TIMER;
+      const unsigned idle = game.sleepPendingSubs();
+      LOG_INFO << "Turn " << game.getTurnNumber() << " timed out, "
+               << idle << " sub(s) without orders";
+      executeTurn();
+    }
+  }
+}
+
+//-----------------------------------------------------------------------------
+// Every complete line already buffered for the handle is dispatched in one
+// pass.  The batch ends early when a line completes the turn, so anything
+// after it is applied to the next turn just as if it arrived separately.
 //-----------------------------------------------------------------------------
 void
 Server::handlePlayerInput(const int handle) {
-  if (!input.readln(handle)) {
-    removePlayer(handle);
-    if (game.isStarted() && !game.isFinished() && (game.getPlayerCount() < 1)) {
-      game.finish();
+  do {
+    if (!input.readln(handle)) {
+      if (input.isLinePending()) {
+        break; // the rest of the line hasn't arrived yet
+      }
+      removePlayer(handle);
+      if (game.isStarted() && !game.isFinished() &&
+          (game.getPlayerCount() < 1))
+      {
+        game.finish();
+      }
+      break;
     }
-  } else {
+
     std::string err;
     std::string str = input.getStr();
     if (str == "J") {
       joinGame(handle);
+    } else if (str == "G") {
+      changeRoom(handle);
     } else if (!game.addCommand(handle, input, err)) {
       removePlayer(handle, err);
     }
-  }
+  } while (input.hasLine(handle) && !game.allCommandsReceived());
 
   if (game.allCommandsReceived()) {
-    std::map<unsigned, std::string> errs = game.executeTurn(gameLog);
-    for (auto it = errs.begin(); it != errs.end(); ++it) {
-      removePlayer(static_cast<int>(it->first), it->second);
+    executeTurn();
+  }
+}
+
+//-----------------------------------------------------------------------------
+void
+Server::handlePlayerOutput(const int handle) {
+  PlayerPtr player = game.getPlayer(handle);
+  if (!player) {
+    auto it = stagedPlayers.find(handle);
+    if (it == stagedPlayers.end()) {
+      return;
     }
+    player = it->second;
+  }
+  if (!player->sendBacklog()) {
+    removePlayer((*player), COMM_ERROR);
   }
 }
 
+//-----------------------------------------------------------------------------
+bool
+Server::handleControlInput() {
+  if (!input.readln(controlHandle)) {
+    if (input.getLine(false).empty() && !input.isLinePending()) {
+      LOG_INFO << "Control channel closed";
+      closeControl();
+    }
+    return true;
+  }
+
+  const std::string cmd = input.getStr();
+  if (iEqual(cmd, "status")) {
+    reportStatus();
+  } else if (iEqual(cmd, "start")) {
+    if (game.canStart() && !game.isStarted()) {
+      beginGame();
+    } else {
+      report("Game can not be started");
+    }
+  } else if (iEqual(cmd, "boot")) {
+    bootPlayer(input.getStr(1));
+  } else if (iEqual(cmd, "ban")) {
+    blacklistPlayer(input.getStr(1));
+  } else if (iEqual(cmd, "banaddr")) {
+    blacklistAddress(input.getStr(1));
+  } else if (iEqual(cmd, "clear")) {
+    blackList.clear();
+    report("Blacklist cleared");
+  } else if (iEqual(cmd, "quit")) {
+    if (game.isStarted()) {
+      game.abort();
+    }
+    return false;
+  } else {
+    report(Msg() << "Unknown command '" << cmd << "', expected status, start, "
+           << "boot|<player>, ban|<player>, banaddr|<address>, clear, quit");
+  }
+  return true;
+}
+
 //-----------------------------------------------------------------------------
 bool
 Server::handleUserInput(Coordinate coord) {
@@ -484,6 +817,117 @@ Server::handleUserInput(Coordinate coord) {
   return true;
 }
 
+//-----------------------------------------------------------------------------
+void
+Server::host() {
+  try {
+    while (!stopped) {
+      game.reset(newGameConfig(), roomTitle, newGameSeed());
+      updateSeats();
+      while (!stopped && !game.isFinished()) {
+        waitForInput();
+        updateSeats();
+      }
+      if (stopped && game.isStarted() && !game.isFinished()) {
+        game.abort();
+      }
+      if (game.isAborted()) {
+        sendGameResults();
+      } else if (game.isFinished()) {
+        sendGameResults();
+        saveResult();
+      }
+      LOG_INFO << "Room " << roomNumber << " '" << roomTitle
+               << "' game " << (game.isAborted() ? "aborted" : "over")
+               << " after " << game.getTurnNumber() << " turns";
+      close();
+    }
+  }
+  catch (const std::exception& e) {
+    Logger::error() << "Room " << roomNumber << " '" << roomTitle
+                    << "' failed: " << e.what();
+  }
+  accepting = false;
+  close();
+}
+
+//-----------------------------------------------------------------------------
+// A room is open while it has seats not taken by joined or staged players,
+// so the lobby never sends more connections than the game can start with
+//-----------------------------------------------------------------------------
+void
+Server::updateSeats() {
+  const unsigned maxPlayers = game.getConfig().getMaxPlayers();
+  const unsigned seats = maxPlayers ? maxPlayers
+                                    : game.getConfig().getMinPlayers();
+  accepting = (!stopped && !game.isStarted() &&
+               ((game.getPlayerCount() + stagedPlayers.size()) < seats));
+}
+
+//-----------------------------------------------------------------------------
+void
+Server::handoff(Socket&& connection, const bool requested) {
+  {
+    std::lock_guard<std::mutex> lock(handoffMutex);
+    handoffs.push_back(Handoff { std::move(connection), requested });
+  }
+  wakeup.writeln();
+}
+
+//-----------------------------------------------------------------------------
+void
+Server::stop() {
+  stopped = true;
+  wakeup.writeln();
+}
+
+//-----------------------------------------------------------------------------
+// Accept connections the lobby has routed here.  A room that filled up
+// after the lobby picked it sends them back to be placed again, unless the
+// client asked for this room by title.
+//-----------------------------------------------------------------------------
+void
+Server::takeHandoffs() {
+  char buf[256];
+  if (::read(wakeup.getReadHandle(), buf, sizeof(buf)) < 0) {
+    Logger::error() << "Room " << roomNumber << " wakeup read failed: "
+                    << toError(errno);
+  }
+
+  std::vector<Handoff> batch;
+  {
+    std::lock_guard<std::mutex> lock(handoffMutex);
+    batch.swap(handoffs);
+  }
+
+  for (Handoff& h : batch) {
+    updateSeats();
+    if (accepting || (h.requested && !stopped && !game.isStarted())) {
+      addConnection(std::move(h.connection));
+    } else {
+      lobby->route(std::move(h.connection));
+    }
+  }
+}
+
+//-----------------------------------------------------------------------------
+void
+Server::changeRoom(const int handle) {
+  auto it = stagedPlayers.find(handle);
+  const std::string title = input.getStr(1);
+  if (!lobby || (it == stagedPlayers.end()) || title.empty() ||
+      it->second->hasBacklog())
+  {
+    removePlayer(handle, PROTOCOL_ERROR);
+    return;
+  }
+
+  PlayerPtr player = it->second;
+  input.removeHandle(handle);
+  stagedPlayers.erase(it);
+  lobby->route(player->releaseConnection(), title);
+}
+
 //-----------------------------------------------------------------------------
 void
 Server::joinGame(const int handle) {
@@ -500,9 +944,9 @@ Server::joinGame(const int handle) {
   } else if (game.getPlayer(player->handle())) {
     throw Error(Msg() << "duplicate player handle (" << player->handle()
                 << ") in join command!");
-  } else if (game.isStarted()) {
-    throw Error("Server.joinGame() game already started");
-  } else if (maxPlayers && (game.getPlayerCount() >= maxPlayers)) {
+  } else if (game.isStarted() ||
+             (maxPlayers && (game.getPlayerCount() >= maxPlayers)))
+  {
     removePlayer((*player), GAME_FULL);
     return;
   }
@@ -536,9 +980,14 @@ Server::joinGame(const int handle) {
 
   // send confirmation to joining Player
   send((*player), Msg('J') << playerName);
-
-  // start the game if max player count reached and autoStart enabled
-  if (maxPlayers && (game.getPlayerCount() == maxPlayers)) {
+  report(Msg() << playerName << " joined from " << player->getAddress());
+
+  // start the game if max player count reached and autoStart enabled,
+  // lobby rooms have no operator so they start at min players if no max
+  const unsigned startAt = (maxPlayers || !lobby)
+      ? maxPlayers
+      : game.getConfig().getMinPlayers();
+  if (startAt && (game.getPlayerCount() == startAt)) {
     if (autoStart) {
       beginGame();
     } else {
@@ -557,16 +1006,20 @@ Server::printGameInfo(Coordinate& coord) {
 //-----------------------------------------------------------------------------
 void
 Server::printMap(Coordinate& coord) {
-  Coordinate topLeft(coord);
-  Screen::print() << topLeft; // << ClearToScreenEnd;
-  game.getMap().print(coord);
-  if (animate) {
-    Screen::print() << topLeft;
-    for (auto&& shot : game.shotsFired()) {
-      game.getMap().animateShot(topLeft, shot);
-    }
+  // snapshot once per turn, drawing and animating it happens on the
+  // renderer thread so it never holds up the game
+  const GameMap& map = game.getMap();
+  if (!renderer.isRunning()) {
+    renderer.start(coord, animate);
+  }
+  if (renderedTurn != game.getTurnNumber()) {
+    renderedTurn = game.getTurnNumber();
+    renderer.submit(std::make_shared<const MapSnapshot>(
+        map, renderedTurn,
+        (animate ? game.shotsFired() : MapSnapshot::TorpedoShots())));
     // TODO animate mine detonations and nuclear detonations
   }
+  coord.south(map.getHeight() + 2);
 }
 
 //-----------------------------------------------------------------------------
@@ -672,7 +1125,12 @@ Server::removePlayer(Player& player, const std::string& msg) {
     }
     stagedPlayers.erase(it);
   } else {
+    if (game.isStarted() && !game.isFinished()) {
+      gameLog() << "REMOVED: " << name << '|' << msg << '\n';
+    }
     game.removePlayer(handle);
+    report(Msg() << name << " removed" << (msg.size() ? (" (" + msg + ")")
+                                                       : std::string()));
   }
 
   if (!game.isStarted() && !socket.isOpen() &&
@@ -691,10 +1149,38 @@ Server::removeStagedPlayer(const int handle) {
   }
 }
 
+//-----------------------------------------------------------------------------
+// Headless status goes to stdout one line at a time, so it can be piped
+// into a log or a supervisor instead of a terminal
+//-----------------------------------------------------------------------------
+void
+Server::report(const std::string& status) {
+  if (headless) {
+    std::cout << status << std::endl;
+  }
+}
+
+//-----------------------------------------------------------------------------
+void
+Server::reportStatus() {
+  const char* state = game.isAborted()  ? "aborted"
+                    : game.isFinished() ? "finished"
+                    : game.isStarted()  ? "in progress"
+                                        : "not started";
+  report(Msg() << "Game '" << game.getTitle() << "' " << state << ", turn "
+         << game.getTurnNumber() << ", " << game.getPlayerCount()
+         << " players, " << stagedPlayers.size() << " connecting, "
+         << blackList.size() << " blacklisted");
+  for (auto& player : game.getPlayers()) {
+    report("  " + player->summary(game.isStarted()));
+  }
+}
+
 //-----------------------------------------------------------------------------
 void
 Server::saveResult() {
   const CommandArgs& args = CommandArgs::getInstance();
+  std::lock_guard<std::mutex> lock(dbMutex);
   FileSysDatabase db;
   db.open(args.getStrAfter({"-d", "--db-dir"}));
   game.saveResults(db);
@@ -709,19 +1195,23 @@ Server::sendGameResults() {
       << game.getTurnNumber()
       << (game.isAborted() ? "aborted" : "finished");
 
-  gameLog << "SERVER ALL: " << finishMessage << std::endl;
+  gameLog() << "SERVER ALL: " << finishMessage << '\n';
 
   // get local list of players (in case any drop out while sending)
   std::vector<PlayerPtr> players = game.getPlayers();
+  for (auto& recipient : players) {
+    if (recipient->isConnected()) {
+      gameLog() << "SERVER ALL: "
+                << (Msg('P') << recipient->getName() << recipient->getScore())
+                << '\n';
+    }
+  }
+  gameLog().flush();
 
   // send finish message and player result messages to all Players
   for (auto& recipient : players) {
     if (recipient->isConnected()) {
       send((*recipient), finishMessage);
-      gameLog << "SERVER ALL: "
-              << (Msg('P') << recipient->getName() << recipient->getScore())
-              << std::endl;
-
       for (auto& player : players) {
         send((*recipient), Msg('P') << player->getName() << player->getScore());
       }
@@ -756,6 +1246,10 @@ Server::startGame(Coordinate coord) {
 //-----------------------------------------------------------------------------
 void
 Server::startListening() {
+  if (lobby) {
+    return; // the lobby does the listening, see updateSeats()
+  }
+
   const int playerCount = static_cast<int>(game.getPlayerCount());
   int backlog = static_cast<int>(game.getConfig().getMaxPlayers());
   if (backlog <= 0) {
@@ -773,6 +1267,18 @@ Server::startListening() {
   input.addHandle(socket.getHandle());
 }
 
+//-----------------------------------------------------------------------------
+void
+Server::startTurnTimer() {
+  timers.cancel(turnTimer);
+  turnTimer = TimerWheel::NO_TIMER;
+
+  const unsigned timeout = game.getConfig().getTurnTimeout();
+  if (timeout && game.isStarted() && !game.isFinished()) {
+    turnTimer = timers.schedule(Timer::now() + timeout);
+  }
+}
+
 //-----------------------------------------------------------------------------
 void
 Server::stopListening() {
@@ -782,12 +1288,26 @@ Server::stopListening() {
   }
 }
 
+//-----------------------------------------------------------------------------
+// Only poll for writability while a player has output waiting, otherwise
+// every idle connection would wake the server on each pass
+//-----------------------------------------------------------------------------
+void
+Server::watchBacklogs() {
+  for (const PlayerPtr& player : game.getPlayers()) {
+    input.watchWritable(player->handle(), player->hasBacklog());
+  }
+  for (auto& staged : stagedPlayers) {
+    input.watchWritable(staged.first, staged.second->hasBacklog());
+  }
+}
+
 //-----------------------------------------------------------------------------
 void
 Server::viewMap() {
   if (!game.isStarted()) {
     Coordinate coord(1, 1);
-    printMap(coord);
+    game.getMap().print(coord);
     prompt(coord, "RET=continue");
   }
 }
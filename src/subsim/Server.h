@@ -6,22 +6,43 @@
 
 #include "utils/Platform.h"
 #include "utils/Input.h"
+#include "utils/LogWriter.h"
+#include "utils/Pipe.h"
 #include "utils/Socket.h"
+#include "utils/TimerWheel.h"
 #include "utils/Version.h"
+#include "BinaryGameLog.h"
 #include "GameConfig.h"
 #include "Game.h"
+#include "MapRenderer.h"
 #include "Player.h"
-#include <fstream>
+#include <atomic>
+#include <mutex>
 
 namespace subsim
 {
 
+//-----------------------------------------------------------------------------
+class Lobby;
+
 //-----------------------------------------------------------------------------
 class Server {
 //-----------------------------------------------------------------------------
 public: // enums
   enum {
-    DEFAULT_PORT = 9555
+    DEFAULT_PORT = 9555,
+    DEFAULT_MAX_BACKLOG = (256 * 1024)
+  };
+
+//-----------------------------------------------------------------------------
+public: // constants
+  static const unsigned NO_TURN = ~0U;
+
+//-----------------------------------------------------------------------------
+private: // types
+  struct Handoff {
+    Socket connection;
+    bool requested; // client asked for this room by title
   };
 
 //-----------------------------------------------------------------------------
@@ -29,16 +50,37 @@ private: // variables
   bool autoStart = false;
   bool repeat = false;
   bool animate = false;
+  bool headless = false;
+  bool skipSlowClients = false;
+  unsigned maxBacklog = DEFAULT_MAX_BACKLOG;
+  int controlHandle = STDIN_FILENO; // admin commands, -1 = none
   Game game;
   Input input;
+  MapRenderer renderer;
+  unsigned renderedTurn = NO_TURN; // last turn given to the renderer
   Socket socket;
-  std::ofstream gameLog;
+  TimerWheel timers;
+  TimerWheel::TimerID turnTimer = TimerWheel::NO_TIMER;
+  std::vector<TimerWheel::TimerID> expiredTimers;
+  LogWriter textLog;
+  BinaryGameLog binaryLog;
   std::set<std::string> blackList;
   std::map<int, PlayerPtr> stagedPlayers;
 
+  // lobby room state, the lobby thread only touches what's below
+  Lobby* lobby = nullptr;
+  unsigned roomNumber = 0;
+  std::string roomTitle;
+  Pipe wakeup;
+  std::mutex handoffMutex;
+  std::vector<Handoff> handoffs;
+  std::atomic<bool> accepting{false};
+  std::atomic<bool> stopped{false};
+
 //-----------------------------------------------------------------------------
 public: // constructors
   Server() { input.addHandle(STDIN_FILENO); }
+  explicit Server(Lobby&, const unsigned roomNumber, const std::string& title);
   Server(Server&&) = delete;
   Server(const Server&) = delete;
   Server& operator=(Server&&) = delete;
@@ -46,7 +88,10 @@ public: // constructors
 
 //-----------------------------------------------------------------------------
 public: // destructor
-  ~Server() { close(); }
+  ~Server() {
+    close();
+    closeControl();
+  }
 
 //-----------------------------------------------------------------------------
 public: // static methods
@@ -59,50 +104,88 @@ public: // methods
   bool run();
   bool isAutoStart() const { return autoStart; }
   bool isRepeatOn() const { return repeat; }
+  bool isHeadless() const { return headless; }
+
+  // lobby room methods, host() runs on the room's own thread and the rest
+  // may be called from any thread
+  void host();
+  void handoff(Socket&&, const bool requested = false);
+  void stop();
+  bool isAccepting() const noexcept { return accepting; }
+  unsigned getRoomNumber() const noexcept { return roomNumber; }
+  const std::string& getRoomTitle() const noexcept { return roomTitle; }
 
 //-----------------------------------------------------------------------------
 private: // methods
+  std::ostream& gameLog() {
+    return binaryLog.isOpen() ? static_cast<std::ostream&>(binaryLog)
+                              : textLog;
+  }
+
   std::string prompt(Coordinate,
                      const std::string& question,
                      const char fieldDelimeter = 0);
 
   GameConfig newGameConfig();
+  uint64_t newGameSeed();
 
   bool getGameTitle(std::string&);
+  bool handleControlInput();
   bool handleUserInput(Coordinate);
   bool isServerHandle(const int) const;
   bool isUserHandle(const int) const;
   bool isValidPlayerName(const std::string&) const;
   bool quitGame(Coordinate);
+  bool runHeadless(const std::string& title);
   bool sendGameInfo(Player&);
   bool waitForInput(const int timeout = -1);
   bool send(Player& recipient, const std::string& msg,
             const bool removeOnFailure = true);
 
   void addPlayerHandle();
+  void addConnection(Socket&&);
+  void changeRoom(const int handle);
   void beginGame();
   void blacklistAddress(Coordinate);
+  void blacklistAddress(const std::string& address);
   void blacklistPlayer(Coordinate);
+  void blacklistPlayer(const std::string& nameOrNumber);
   void bootPlayer(Coordinate);
+  void bootPlayer(const std::string& nameOrNumber);
   void clearBlacklist(Coordinate);
   void clearScreen();
   void close();
+  void closeControl();
+  void executeTurn();
+  void expireTimers();
   void handlePlayerInput(const int handle);
+  void handlePlayerOutput(const int handle);
+  void openGameLog(const std::string& suffix);
+  void setBacklogOptions();
   void joinGame(const int handle);
   void printGameInfo(Coordinate&);
   void printMap(Coordinate&);
   void printOptions(Coordinate&);
   void printPlayers(Coordinate&);
+  void openControl(const std::string& path);
   void removePlayer(const int handle, const std::string& msg = "");
   void removePlayer(Player&, const std::string& msg = "");
   void removeStagedPlayer(const int);
+  void report(const std::string& status);
+  void reportStatus();
   void saveResult();
   void sendGameResults();
   void sendToAll(const std::string& msg);
   void startGame(Coordinate);
   void startListening();
+  void startTurnTimer();
+  void takeHandoffs();
+  void updateSeats();
   void stopListening();
   void viewMap();
+  void watchBacklogs();
+
+  PlayerPtr findPlayer(const std::string& nameOrNumber) const;
 };
 
 } // namespace subsim
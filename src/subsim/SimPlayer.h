@@ -0,0 +1,94 @@
+//-----------------------------------------------------------------------------
+// Copyright (c) 2017 Shawn Chidester, All rights reserved
+//-----------------------------------------------------------------------------
+#ifndef SUBSIM_SIM_PLAYER_H
+#define SUBSIM_SIM_PLAYER_H
+
+#include "utils/Platform.h"
+#include "Player.h"
+
+namespace subsim
+{
+
+//-----------------------------------------------------------------------------
+// A player with no socket, messages sent to it are queued in memory
+//-----------------------------------------------------------------------------
+class SimPlayer : public Player {
+//-----------------------------------------------------------------------------
+private: // variables
+  int id;
+  bool muted = false; // discard messages, see Simulation::simulateTurn()
+  std::vector<std::string> inbox;
+
+//-----------------------------------------------------------------------------
+public: // constructors
+  SimPlayer() = delete;
+  SimPlayer(SimPlayer&&) = delete;
+  SimPlayer(const SimPlayer&) = delete;
+  SimPlayer& operator=(SimPlayer&&) = delete;
+  SimPlayer& operator=(const SimPlayer&) = delete;
+
+  explicit SimPlayer(const std::string& name, const int id)
+    : Player(name),
+      id(id)
+  { }
+
+//-----------------------------------------------------------------------------
+public: // Player overrides
+  bool send(const std::string& msg) override {
+    if (!muted) {
+      inbox.push_back(msg);
+    }
+    return true;
+  }
+
+  bool flush(const std::string& head, const std::string& tail) override {
+    if (!muted) {
+      receive(head);
+      receive(output);
+      receive(tail);
+    }
+    output.clear();
+    return true;
+  }
+
+  bool isConnected() const noexcept override {
+    return true;
+  }
+
+  int handle() const noexcept override {
+    return id;
+  }
+
+//-----------------------------------------------------------------------------
+public: // methods
+  const std::vector<std::string>& getMessages() const noexcept {
+    return inbox;
+  }
+
+  void clearMessages() noexcept {
+    inbox.clear();
+  }
+
+  void setMuted(const bool value) noexcept {
+    muted = value;
+  }
+
+//-----------------------------------------------------------------------------
+private: // methods
+  void receive(const std::string& lines) {
+    std::string::size_type begin = 0;
+    std::string::size_type end;
+    while ((end = lines.find('\n', begin)) != std::string::npos) {
+      inbox.push_back(lines.substr(begin, (end - begin)));
+      begin = (end + 1);
+    }
+  }
+};
+
+//-----------------------------------------------------------------------------
+typedef std::shared_ptr<SimPlayer> SimPlayerPtr;
+
+} // namespace subsim
+
+#endif // SUBSIM_SIM_PLAYER_H
@@ -0,0 +1,195 @@
+//-----------------------------------------------------------------------------
+// Copyright (c) 2017 Shawn Chidester, All rights reserved
+//-----------------------------------------------------------------------------
+#include "Simulation.h"
+#include "utils/Error.h"
+#include "utils/Logger.h"
+#include "utils/Msg.h"
+
+namespace subsim
+{
+
+//-----------------------------------------------------------------------------
+// Keeps the output of a simulated turn out of the players' inboxes
+//-----------------------------------------------------------------------------
+class MutePlayers {
+  const std::vector<SimPlayerPtr>& players;
+
+public:
+  explicit MutePlayers(const std::vector<SimPlayerPtr>& players)
+    : players(players)
+  {
+    setMuted(true);
+  }
+
+  ~MutePlayers() { setMuted(false); }
+
+private:
+  void setMuted(const bool muted) noexcept {
+    for (const SimPlayerPtr& player : players) {
+      player->setMuted(muted);
+    }
+  }
+};
+
+//-----------------------------------------------------------------------------
+void
+Simulation::reset(const GameConfig& config,
+                  const std::string& title,
+                  const uint64_t seed,
+                  const std::string& gameLogFile)
+{
+  close();
+  if (gameLogFile.size()) {
+    if (!logFile.open(gameLogFile)) {
+      throw Error(Msg() << "Failed to open game log file: " << gameLogFile);
+    }
+  }
+  game.reset(config, title, seed);
+}
+
+//-----------------------------------------------------------------------------
+void
+Simulation::reset(const GameConfig& config,
+                  const std::string& title,
+                  const uint64_t seed,
+                  std::ostream& gameLog)
+{
+  close();
+  logStream = &gameLog;
+  game.reset(config, title, seed);
+}
+
+//-----------------------------------------------------------------------------
+void
+Simulation::close() {
+  game.clearPlayers();
+  simPlayers.clear();
+  nextHandle = 1;
+  logFile.close();
+  logStream = nullptr;
+}
+
+//-----------------------------------------------------------------------------
+SimPlayerPtr
+Simulation::addPlayer(const std::string& name,
+                      const std::vector<Coordinate>& subLocations)
+{
+  SimPlayerPtr player = std::make_shared<SimPlayer>(name, nextHandle);
+  const std::string err = game.addPlayer(player, subLocations);
+  if (err.size()) {
+    throw Error(Msg() << "Simulation::addPlayer(" << name << ") " << err);
+  }
+  player->send(Msg('J') << name);
+  simPlayers.push_back(player);
+  nextHandle++;
+  return player;
+}
+
+//-----------------------------------------------------------------------------
+SimPlayerPtr
+Simulation::getPlayer(const int handle) const {
+  // handles are assigned sequentially starting at 1
+  if ((handle > 0) && (static_cast<unsigned>(handle) <= simPlayers.size())) {
+    return simPlayers[handle - 1];
+  }
+  return nullptr;
+}
+
+//-----------------------------------------------------------------------------
+bool
+Simulation::addCommand(const Command& command) {
+  std::string err;
+  const int handle = static_cast<int>(command.getPlayerID());
+  if (!game.addCommand(handle, command, err)) {
+    removePlayer(handle, err);
+    return false;
+  }
+  return true;
+}
+
+//-----------------------------------------------------------------------------
+// Same as addCommand() but a rejected command only reports why, the player
+// stays in the game so lookahead can try something else
+//-----------------------------------------------------------------------------
+bool
+Simulation::tryCommand(const Command& command, std::string& err) {
+  const int handle = static_cast<int>(command.getPlayerID());
+  return game.addCommand(handle, command, err);
+}
+
+//-----------------------------------------------------------------------------
+bool
+Simulation::removePlayer(const std::string& name, const std::string& msg) {
+  PlayerPtr player = game.getPlayer(name);
+  if (player) {
+    removePlayer(player->handle(), msg);
+    return true;
+  }
+  return false;
+}
+
+//-----------------------------------------------------------------------------
+void
+Simulation::start() {
+  const GameConfig& config = game.getConfig();
+  gameLog() << "NEW_GAME: "
+            << config.toMessage(GameConfig::getServerVersion(), game.getTitle())
+            << '\n';
+
+  for (const GameSetting& setting : config.getCustomSettings()) {
+    gameLog() << "SERVER ALL: " << setting.toMessage() << '\n';
+  }
+
+  char ch = 'A';
+  for (const PlayerPtr& player : game.getPlayers()) {
+    player->setMapChar(ch++);
+    gameLog() << "SERVER ALL: J|" << player->getName() << '\n';
+  }
+
+  std::map<unsigned, std::string> errs = game.start(gameLog());
+  for (auto it = errs.begin(); it != errs.end(); ++it) {
+    removePlayer(static_cast<int>(it->first), it->second);
+  }
+}
+
+//-----------------------------------------------------------------------------
+void
+Simulation::executeTurn() {
+  std::map<unsigned, std::string> errs = game.executeTurn(gameLog());
+  for (auto it = errs.begin(); it != errs.end(); ++it) {
+    removePlayer(static_cast<int>(it->first), it->second);
+  }
+  if (game.isStarted() && !game.isFinished() && (game.getPlayerCount() < 1)) {
+    game.finish();
+  }
+}
+
+//-----------------------------------------------------------------------------
+// Execute the turn without writing it to the game log, sending its output
+// to the players or removing players whose commands failed, so the game
+// can be put back with restoreState().
+// Commands for it should go through tryCommand(), addCommand() removes the
+// player when one is rejected and the saved state no longer fits the game.
+//-----------------------------------------------------------------------------
+void
+Simulation::simulateTurn() {
+  MutePlayers mute(simPlayers);
+  UNUSED(mute);
+  game.executeTurn(nullLog);
+}
+
+//-----------------------------------------------------------------------------
+void
+Simulation::removePlayer(const int handle, const std::string& msg) {
+  PlayerPtr player = game.getPlayer(handle);
+  if (player) {
+    LOG_DEBUG << "removing " << player->getName() << ": " << msg;
+    if (msg.size()) {
+      player->send(msg);
+    }
+    game.removePlayer(handle);
+  }
+}
+
+} // namespace subsim
@@ -0,0 +1,96 @@
+//-----------------------------------------------------------------------------
+// Copyright (c) 2017 Shawn Chidester, All rights reserved
+//-----------------------------------------------------------------------------
+#ifndef SUBSIM_SIMULATION_H
+#define SUBSIM_SIMULATION_H
+
+#include "utils/Platform.h"
+#include "utils/LogWriter.h"
+#include "GameConfig.h"
+#include "Game.h"
+#include "SimPlayer.h"
+
+namespace subsim
+{
+
+//-----------------------------------------------------------------------------
+// Runs a Game in-process without sockets, terminal UI, or an event loop
+//-----------------------------------------------------------------------------
+class Simulation {
+//-----------------------------------------------------------------------------
+private: // variables
+  Game game;
+  LogWriter logFile;
+  std::ostream* logStream = nullptr; // used instead of logFile if set
+  std::ostream nullLog{nullptr};
+  std::vector<SimPlayerPtr> simPlayers;
+  int nextHandle = 1;
+
+//-----------------------------------------------------------------------------
+public: // constructors
+  Simulation() = default;
+  Simulation(Simulation&&) = delete;
+  Simulation(const Simulation&) = delete;
+  Simulation& operator=(Simulation&&) = delete;
+  Simulation& operator=(const Simulation&) = delete;
+
+//-----------------------------------------------------------------------------
+public: // destructor
+  ~Simulation() { close(); }
+
+//-----------------------------------------------------------------------------
+public: // methods
+  const Game& getGame() const noexcept { return game; }
+  unsigned getTurnNumber() const noexcept { return game.getTurnNumber(); }
+  bool isFinished() const noexcept { return game.isFinished(); }
+  bool allCommandsReceived() const noexcept {
+    return game.allCommandsReceived();
+  }
+
+  const std::vector<SimPlayerPtr>& getPlayers() const noexcept {
+    return simPlayers;
+  }
+
+  void reset(const GameConfig&,
+             const std::string& gameTitle,
+             const uint64_t seed,
+             const std::string& gameLogFile = "");
+
+  void reset(const GameConfig&,
+             const std::string& gameTitle,
+             const uint64_t seed,
+             std::ostream& gameLog);
+
+  SimPlayerPtr addPlayer(const std::string& name,
+                         const std::vector<Coordinate>& subLocations);
+
+  SimPlayerPtr getPlayer(const int handle) const;
+
+  bool addCommand(const Command&);
+  bool tryCommand(const Command&, std::string& err);
+  bool removePlayer(const std::string& name, const std::string& msg = "");
+  void start();
+  void executeTurn();
+
+  // lookahead: save the game, try turns with tryCommand() and
+  // simulateTurn(), and restore
+  void saveState(GameState& state) const { game.saveState(state); }
+  void restoreState(const GameState& state) { game.restoreState(state); }
+  void simulateTurn();
+  void abort() noexcept { game.abort(); }
+  void finish() noexcept { game.finish(); }
+  void close();
+
+//-----------------------------------------------------------------------------
+private: // methods
+  std::ostream& gameLog() {
+    return logStream ? (*logStream)
+        : logFile.isOpen() ? static_cast<std::ostream&>(logFile) : nullLog;
+  }
+
+  void removePlayer(const int handle, const std::string& msg);
+};
+
+} // namespace subsim
+
+#endif // SUBSIM_SIMULATION_H
@@ -11,16 +11,30 @@
 namespace subsim
 {
 
+//-----------------------------------------------------------------------------
+// Objects are not owned by the square that contains them.  Up to
+// INLINE_CAPACITY object pointers are stored in the square itself, beyond
+// that they all move to a heap allocated spill vector.  Mines and
+// submarines are counted as they come and go so blast and sonar resolution
+// can skip squares without inspecting their objects.
 //-----------------------------------------------------------------------------
 class Square : public Coordinate {
 //-----------------------------------------------------------------------------
-public: // variables
-  std::list<ObjectPtr> objects;
+public: // constants
+  static const unsigned INLINE_CAPACITY = 3;
+
+//-----------------------------------------------------------------------------
+private: // variables
+  Object* inlineObjects[INLINE_CAPACITY];
+  std::vector<Object*> spill;
+  unsigned count = 0;
+  unsigned mineCount = 0;
+  unsigned subCount = 0;
 
 //-----------------------------------------------------------------------------
 public: // constructors
   Square() = delete;
-  Square(Square&&) = delete;
+  Square(Square&&) noexcept = default;
   Square(const Square&) = delete;
   Square& operator=(Square&&) = delete;
   Square& operator=(const Square&) = delete;
@@ -32,55 +46,68 @@ public: // constructors
 //-----------------------------------------------------------------------------
 public: // methods
   bool isEmpty() const noexcept {
-    return objects.empty();
+    return !count;
   }
 
   bool isOccupied() const noexcept {
-    return !objects.empty();
+    return count;
   }
 
   bool isBlocked() const noexcept {
-    return ((objects.size() == 1) && objects.front()->isPermanent());
+    return ((count == 1) && objects()[0]->isPermanent());
   }
 
-  bool contains(ObjectPtr object) const noexcept {
-    if (object) {
-      Object* ptr = object.get();
-      for (ObjectPtr obj : objects) {
-        if (obj.get() == ptr) {
-          return true;
-        }
-      }
-    }
-    return false;
+  bool hasMines() const noexcept {
+    return mineCount;
+  }
+
+  bool hasSubmarines() const noexcept {
+    return subCount;
   }
 
-  bool addObject(ObjectPtr object) {
-    if (isBlocked()) {
+  unsigned getMineCount() const noexcept {
+    return mineCount;
+  }
+
+  unsigned getSubmarineCount() const noexcept {
+    return subCount;
+  }
+
+  bool contains(const Object* object) const noexcept {
+    return (object && (std::find(begin(), end(), object) != end()));
+  }
+
+  bool addObject(Object* object) {
+    if (isBlocked() || !object || contains(object)) {
       return false;
-    } else if (object && !contains(object)) {
-      objects.push_back(object);
-      return true;
     }
-    return false;
+    if (count < INLINE_CAPACITY) {
+      inlineObjects[count] = object;
+    } else {
+      if (count == INLINE_CAPACITY) {
+        spill.assign(inlineObjects, (inlineObjects + INLINE_CAPACITY));
+      }
+      spill.push_back(object);
+    }
+    count++;
+    countObject(object, 1);
+    return true;
   }
 
-  bool removeObject(ObjectPtr object) {
-    if (object) {
-      Object* ptr = object.get();
-      for (auto it = objects.begin(); it != objects.end(); ++it) {
-        if (it->get() == ptr) {
-          objects.erase(it);
-          return true;
-        }
-      }
+  bool removeObject(const Object* object) noexcept {
+    Object** first = objects();
+    Object** last = (first + count);
+    Object** it = std::find(first, last, object);
+    if (!object || (it == last)) {
+      return false;
     }
-    return false;
+    erase(it);
+    return true;
   }
 
   unsigned getSizeOfObjects() const noexcept {
     unsigned size = 0;
-    for (const auto& object : objects) {
+    for (const Object* object : (*this)) {
       if (object->getSize() != ~0U) {
         size += object->getSize();
       } else {
@@ -91,33 +118,68 @@ public: // methods
   }
 
   unsigned getObjectCount() const noexcept {
-    return objects.size();
+    return count;
   }
 
-  std::list<ObjectPtr>::const_iterator begin() const noexcept {
-    return objects.begin();
+  Object* const* begin() const noexcept {
+    return objects();
   }
 
-  std::list<ObjectPtr>::const_iterator end() const noexcept {
-    return objects.end();
+  Object* const* end() const noexcept {
+    return (objects() + count);
   }
 
-  std::list<ObjectPtr>::iterator begin() noexcept {
-    return objects.begin();
+  Object** begin() noexcept {
+    return objects();
   }
 
-  std::list<ObjectPtr>::iterator end() noexcept {
-    return objects.end();
+  Object** end() noexcept {
+    return (objects() + count);
   }
 
-  std::list<ObjectPtr>::iterator erase(std::list<ObjectPtr>::iterator it)
-  noexcept {
-    return objects.erase(it);
+  // removes the object at the given position, preserving the order of the
+  // remaining objects, returns the position of the next object
+  Object** erase(Object** it) noexcept {
+    const unsigned idx = (it - objects());
+    ASSERT(idx < count);
+    countObject((*it), -1);
+    if (count > INLINE_CAPACITY) {
+      spill.erase(spill.begin() + idx);
+      if (--count == INLINE_CAPACITY) {
+        std::copy(spill.begin(), spill.end(), inlineObjects);
+        spill.clear();
+      }
+    } else {
+      std::copy((inlineObjects + idx + 1), (inlineObjects + count),
+                (inlineObjects + idx));
+      count--;
+    }
+    return (objects() + idx);
   }
-};
 
 //-----------------------------------------------------------------------------
-typedef std::unique_ptr<Square> UniqueSquare;
+private: // methods
+  void countObject(const Object* object, const int delta) noexcept {
+    switch (object->getObjectType()) {
+    case Object::MineType:
+      mineCount += delta;
+      break;
+    case Object::SubmarineType:
+      subCount += delta;
+      break;
+    default:
+      break;
+    }
+  }
+
+  Object** objects() noexcept {
+    return (count > INLINE_CAPACITY) ? spill.data() : inlineObjects;
+  }
+
+  Object* const* objects() const noexcept {
+    return (count > INLINE_CAPACITY) ? spill.data() : inlineObjects;
+  }
+};
 
 } // namespace subsim
 
@@ -11,7 +11,7 @@ namespace subsim
 //-----------------------------------------------------------------------------
 Submarine::Submarine(const unsigned subID,
                      const unsigned size) noexcept
-  : Object('?', ~0U, subID, size, false)
+  : Object(SubmarineType, '?', ~0U, subID, size, false)
 { }
 
 //-----------------------------------------------------------------------------
@@ -19,7 +19,8 @@ Submarine::Submarine(const unsigned playerID,
                      const char mapChar,
                      const unsigned subID,
                      const Submarine& sub) noexcept
-  : Object(mapChar, playerID, subID, sub.getSize(), false),
+  : Object(SubmarineType, mapChar, playerID, subID, sub.getSize(),
+           false),
     surfaceTurnCount(sub.surfaceTurnCount),
     maxShields(sub.maxShields),
     maxReactorDamage(sub.maxReactorDamage),
@@ -166,6 +167,46 @@ Submarine::surface() noexcept {
   return false;
 }
 
+//-----------------------------------------------------------------------------
+Submarine::State
+Submarine::getState() const noexcept {
+  const Coordinate& coord = getLocation();
+  return State {
+    static_cast<uint16_t>(coord.getX()),
+    static_cast<uint16_t>(coord.getY()),
+    shieldCount,
+    torpedoCount,
+    mineCount,
+    surfaceTurns,
+    reactorDamage,
+    sonarCharge,
+    torpedoCharge,
+    mineCharge,
+    sprintCharge,
+    dead,
+    detonated
+  };
+}
+
+//-----------------------------------------------------------------------------
+// Does not move the sub on the map, the caller keeps the map in step
+//-----------------------------------------------------------------------------
+void
+Submarine::setState(const State& state) noexcept {
+  setLocation(Coordinate(state.x, state.y));
+  shieldCount = state.shieldCount;
+  torpedoCount = state.torpedoCount;
+  mineCount = state.mineCount;
+  surfaceTurns = state.surfaceTurns;
+  reactorDamage = state.reactorDamage;
+  sonarCharge = state.sonarCharge;
+  torpedoCharge = state.torpedoCharge;
+  mineCharge = state.mineCharge;
+  sprintCharge = state.sprintCharge;
+  dead = state.dead;
+  detonated = state.detonated;
+}
+
 //-----------------------------------------------------------------------------
 void
 Submarine::kill() noexcept {
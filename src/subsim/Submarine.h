@@ -23,6 +23,26 @@ public: // enums
     Sprint
   };
 
+//-----------------------------------------------------------------------------
+public: // types
+  // everything about a sub that changes during a game, as plain data so a
+  // GameState can copy all of its subs in one block
+  struct State {
+    uint16_t x;
+    uint16_t y;
+    unsigned shieldCount;
+    unsigned torpedoCount;
+    unsigned mineCount;
+    unsigned surfaceTurns;
+    unsigned reactorDamage;
+    unsigned sonarCharge;
+    unsigned torpedoCharge;
+    unsigned mineCharge;
+    unsigned sprintCharge;
+    bool dead;
+    bool detonated;
+  };
+
 //-----------------------------------------------------------------------------
 private: // variables
   unsigned surfaceTurnCount = 3;
@@ -206,6 +226,8 @@ public: // command methods
 
 //-----------------------------------------------------------------------------
 public: // methods
+  State getState() const noexcept;
+  void setState(const State&) noexcept;
   void kill() noexcept;
   void repair() noexcept;
   void takeHits(const unsigned hits) noexcept;
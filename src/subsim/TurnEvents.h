@@ -0,0 +1,174 @@
+//-----------------------------------------------------------------------------
+// Copyright (c) 2017 Shawn Chidester, All rights reserved
+//-----------------------------------------------------------------------------
+#ifndef SUBSIM_TURN_EVENTS_H
+#define SUBSIM_TURN_EVENTS_H
+
+#include "utils/Platform.h"
+#include "utils/Coordinate.h"
+
+namespace subsim
+{
+
+//-----------------------------------------------------------------------------
+// Flat record of everything that happened during one turn.  Events are
+// appended as commands execute, then sorted in place so each player's
+// events are contiguous and in the order they are sent.  clear() keeps the
+// buffer's capacity so a running game stops allocating after a few turns.
+//-----------------------------------------------------------------------------
+class TurnEvents {
+//-----------------------------------------------------------------------------
+public: // enums
+  enum EventType : char {  // per player send order
+    SonarHit,              // S: subID spotted at distance
+    SprintHeard,           // R: subID heard sprinting count times
+    Discovery,             // O: object(s) of size found at coord
+    TorpedoHit,            // T: damage inflicted at coord
+    MineHit,               // M: damage inflicted at coord
+    Detonation             // D: blast radius at coord, sent to all players
+  };
+
+//-----------------------------------------------------------------------------
+public: // constants
+  static const unsigned ALL_PLAYERS = ~0U;
+
+//-----------------------------------------------------------------------------
+public: // types
+  struct Event {
+    unsigned playerID;
+    EventType type;
+    unsigned seq;
+    unsigned subID;
+    Coordinate coord;
+    unsigned amount;
+  };
+
+  typedef std::pair<const Event*, const Event*> EventRange;
+
+//-----------------------------------------------------------------------------
+private: // variables
+  std::vector<Event> events;
+
+//-----------------------------------------------------------------------------
+public: // constructors
+  TurnEvents() = default;
+  TurnEvents(TurnEvents&&) = delete;
+  TurnEvents(const TurnEvents&) = delete;
+  TurnEvents& operator=(TurnEvents&&) = delete;
+  TurnEvents& operator=(const TurnEvents&) = delete;
+
+//-----------------------------------------------------------------------------
+public: // methods
+  void clear() noexcept {
+    events.clear();
+  }
+
+  unsigned size() const noexcept {
+    return events.size();
+  }
+
+  void addSonarHit(const unsigned playerID,
+                   const unsigned subID,
+                   const unsigned distance)
+  {
+    add(playerID, SonarHit, subID, Coordinate(), distance);
+  }
+
+  void addSprintHeard(const unsigned playerID, const unsigned subID) {
+    add(playerID, SprintHeard, subID, Coordinate(), 1);
+  }
+
+  void addDiscovery(const unsigned playerID,
+                    const Coordinate& coord,
+                    const unsigned size)
+  {
+    add(playerID, Discovery, 0, coord, size);
+  }
+
+  void addTorpedoHit(const unsigned playerID,
+                     const Coordinate& coord,
+                     const unsigned damage)
+  {
+    add(playerID, TorpedoHit, 0, coord, damage);
+  }
+
+  void addMineHit(const unsigned playerID,
+                  const Coordinate& coord,
+                  const unsigned damage)
+  {
+    add(playerID, MineHit, 0, coord, damage);
+  }
+
+  void addDetonation(const Coordinate& coord, const unsigned radius) {
+    add(ALL_PLAYERS, Detonation, 0, coord, radius);
+  }
+
+  // group events by player and type, merging SprintHeard events for the same
+  // sub and hit events on the same coordinate
+  void sort() {
+    std::sort(events.begin(), events.end(), lessThan);
+    auto last = events.begin();
+    for (auto it = events.begin(); it != events.end(); ++it) {
+      if ((it != last) && isMergeable(*it) && sameKey((*last), (*it))) {
+        last->amount += it->amount;
+      } else if ((it != last) && (++last != it)) {
+        (*last) = (*it);
+      }
+    }
+    if (events.size()) {
+      events.erase((last + 1), events.end());
+    }
+  }
+
+  // must call sort() first
+  EventRange forPlayer(const unsigned playerID) const {
+    const Event* first = events.data();
+    const Event* last = (first + events.size());
+    first = std::lower_bound(first, last, playerID,
+        [](const Event& e, const unsigned id) { return (e.playerID < id); });
+    last = std::upper_bound(first, last, playerID,
+        [](const unsigned id, const Event& e) { return (id < e.playerID); });
+    return EventRange(first, last);
+  }
+
+//-----------------------------------------------------------------------------
+private: // methods
+  void add(const unsigned playerID,
+           const EventType type,
+           const unsigned subID,
+           const Coordinate& coord,
+           const unsigned amount)
+  {
+    const unsigned seq = events.size();
+    events.push_back(Event { playerID, type, seq, subID, coord, amount });
+  }
+
+  static bool isMergeable(const Event& e) noexcept {
+    return ((e.type == SprintHeard) || (e.type == TorpedoHit) ||
+            (e.type == MineHit));
+  }
+
+  static bool sameKey(const Event& a, const Event& b) noexcept {
+    return ((a.playerID == b.playerID) && (a.type == b.type) &&
+            (a.subID == b.subID) && (a.coord == b.coord));
+  }
+
+  static bool lessThan(const Event& a, const Event& b) noexcept {
+    if (a.playerID != b.playerID) {
+      return (a.playerID < b.playerID);
+    } else if (a.type != b.type) {
+      return (a.type < b.type);
+    } else if (isMergeable(a)) {
+      if (a.subID != b.subID) {
+        return (a.subID < b.subID);
+      } else if (a.coord != b.coord) {
+        return (a.coord < b.coord);
+      }
+    }
+    return (a.seq < b.seq);
+  }
+};
+
+} // namespace subsim
+
+#endif // SUBSIM_TURN_EVENTS_H
@@ -5,16 +5,22 @@
 #define SUBSIM_COMMAND_H
 
 #include "utils/Platform.h"
+#include "utils/Coordinate.h"
 #include "utils/Error.h"
 #include "utils/Input.h"
+#include "utils/Movement.h"
 #include "utils/Msg.h"
-#include "utils/Printable.h"
+#include "../Submarine.h"
 
 namespace subsim
 {
 
 //-----------------------------------------------------------------------------
-class Command : public Printable {
+// Commands are small tagged values with no virtual methods so they can be
+// stored by value in preallocated buffers.  Subclasses only supply
+// constructors, they must not add member variables.
+//-----------------------------------------------------------------------------
+class Command {
 //-----------------------------------------------------------------------------
 public: // enums
   enum CommandType {
@@ -35,6 +41,14 @@ private: // variables
   unsigned turnNumber = ~0U;
   unsigned subID = ~0U;
 
+//-----------------------------------------------------------------------------
+protected: // variables
+  Direction dir = North;
+  unsigned distance = 0;
+  Submarine::Equipment equip1 = Submarine::None;
+  Submarine::Equipment equip2 = Submarine::None;
+  Coordinate dest;
+
 //-----------------------------------------------------------------------------
 public: // constructors
   Command() noexcept = default;
@@ -64,6 +78,50 @@ protected: // constructors
       subID(input.getUInt(2, ~0U))
   { }
 
+//-----------------------------------------------------------------------------
+public: // static methods
+  static char typeLetter(const CommandType type) noexcept {
+    switch (type) {
+    case Sleep:       return 'S';
+    case Move:        return 'M';
+    case Sprint:      return 'R';
+    case DeployMine:  return 'D';
+    case FireTorpedo: return 'F';
+    case Surface:     return 'U';
+    case Ping:        return 'P';
+    case Invalid:     break;
+    }
+    return '?';
+  }
+
+//-----------------------------------------------------------------------------
+protected: // static methods
+  static char directionLetter(const Direction dir) noexcept {
+    switch (dir) {
+    case North: return 'N';
+    case East:  return 'E';
+    case South: return 'S';
+    case West:  return 'W';
+    }
+    return '?';
+  }
+
+  static Direction parseDirection(const std::string& str) {
+    if (str.size() == 1) {
+      switch (str[0]) {
+      case 'E':
+        return Direction::East;
+      case 'N':
+        return Direction::North;
+      case 'S':
+        return Direction::South;
+      case 'W':
+        return Direction::West;
+      }
+    }
+    throw Error("Invalid direction: " + str);
+  }
+
 //-----------------------------------------------------------------------------
 public: // getters
   CommandType getType() const noexcept {
@@ -82,6 +140,60 @@ public: // getters
     return subID;
   }
 
+  Direction getDirection() const noexcept {
+    return dir;
+  }
+
+  unsigned getDistance() const noexcept {
+    return distance;
+  }
+
+  Submarine::Equipment getEquip() const noexcept {
+    return equip1;
+  }
+
+  Submarine::Equipment getEquip1() const noexcept {
+    return equip1;
+  }
+
+  Submarine::Equipment getEquip2() const noexcept {
+    return equip2;
+  }
+
+  const Coordinate& getDestination() const noexcept {
+    return dest;
+  }
+
+//-----------------------------------------------------------------------------
+public: // methods
+  std::string toString() const {
+    Msg msg(typeLetter(type));
+    msg << turnNumber << subID;
+    switch (type) {
+    case Sleep:
+      msg << Submarine::equipmentName(equip1)
+          << Submarine::equipmentName(equip2);
+      break;
+    case Move:
+      msg << directionLetter(dir) << Submarine::equipmentName(equip1);
+      break;
+    case Sprint:
+      msg << directionLetter(dir) << distance;
+      break;
+    case DeployMine:
+      msg << directionLetter(dir);
+      break;
+    case FireTorpedo:
+      msg << dest.getX() << dest.getY();
+      break;
+    case Invalid:
+    case Surface:
+    case Ping:
+      break;
+    }
+    return msg;
+  }
+
 //-----------------------------------------------------------------------------
 public: // operator overloads
   bool operator<(const Command& other) const noexcept {
@@ -89,9 +201,6 @@ public: // operator overloads
   }
 };
 
-//-----------------------------------------------------------------------------
-typedef std::unique_ptr<Command> UniqueCommand;
-
 } // namespace subsim
 
 #endif // SUBSIM_COMMAND_H
@@ -20,10 +20,6 @@ class FireCommand : public Command {
 public: // constants
   static const char TYPE = 'F';
 
-//-----------------------------------------------------------------------------
-private: // variables
-  Coordinate dest;
-
 //-----------------------------------------------------------------------------
 public: // constructors
   FireCommand() = delete;
@@ -44,17 +40,13 @@ public: // constructors
     }
   }
 
-//-----------------------------------------------------------------------------
-public: // Command::Printable implementaion
-  std::string toString() const override {
-    return Msg(TYPE) << getTurnNumber() << getSubID()
-                     << dest.getX() << dest.getY();
-  }
-
-//-----------------------------------------------------------------------------
-public: // getters
-  Coordinate getDestination() const noexcept {
-    return dest;
+  FireCommand(const unsigned playerID,
+              const unsigned turnNumber,
+              const unsigned subID,
+              const Coordinate& destination)
+    : Command(Command::FireTorpedo, playerID, turnNumber, subID)
+  {
+    dest = destination;
   }
 };
 
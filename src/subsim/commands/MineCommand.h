@@ -20,11 +20,6 @@ class MineCommand : public Command {
 public: // constants
   static const char TYPE = 'D';
 
-//-----------------------------------------------------------------------------
-private: // variables
-  char dirLetter;
-  Direction dir;
-
 //-----------------------------------------------------------------------------
 public: // constructors
   MineCommand() = delete;
@@ -39,38 +34,16 @@ public: // constructors
     if (input.getFieldCount() != 4) {
       throw Error("Mine command requires 3 values");
     }
-    const std::string str = input.getStr(3);
-    if (str.size() != 1) {
-      throw Error("Invalid direction: " + str);
-    }
-    switch (dirLetter = str[0]) {
-    case 'E':
-      dir = Direction::East;
-      break;
-    case 'N':
-      dir = Direction::North;
-      break;
-    case 'S':
-      dir = Direction::South;
-      break;
-    case 'W':
-      dir = Direction::West;
-      break;
-    default:
-      throw Error("Invalid direction: " + str);
-    }
+    dir = parseDirection(input.getStr(3));
   }
 
-//-----------------------------------------------------------------------------
-public: // Command::Printable implementaion
-  std::string toString() const override {
-    return Msg(TYPE) << getTurnNumber() << getSubID() << dirLetter;
-  }
-
-//-----------------------------------------------------------------------------
-public: // getters
-  Direction getDirection() const noexcept {
-    return dir;
+  MineCommand(const unsigned playerID,
+              const unsigned turnNumber,
+              const unsigned subID,
+              const Direction direction)
+    : Command(Command::DeployMine, playerID, turnNumber, subID)
+  {
+    dir = direction;
   }
 };
 
@@ -21,12 +21,6 @@ class MoveCommand : public Command {
 public: // constants
   static const char TYPE = 'M';
 
-//-----------------------------------------------------------------------------
-private: // variables
-  char dirLetter;
-  Direction dir;
-  Submarine::Equipment equip;
-
 //-----------------------------------------------------------------------------
 public: // constructors
   MoveCommand() = delete;
@@ -41,44 +35,19 @@ public: // constructors
     if (input.getFieldCount() != 5) {
       throw Error("Move command requires 4 values");
     }
-    const std::string str = input.getStr(3);
-    if (str.size() != 1) {
-      throw Error("Invalid direction: " + str);
-    }
-    switch (dirLetter = str[0]) {
-    case 'E':
-      dir = Direction::East;
-      break;
-    case 'N':
-      dir = Direction::North;
-      break;
-    case 'S':
-      dir = Direction::South;
-      break;
-    case 'W':
-      dir = Direction::West;
-      break;
-    default:
-      throw Error("Invalid direction: " + str);
-    }
-    equip = Submarine::getEquipment(input.getStr(4));
+    dir = parseDirection(input.getStr(3));
+    equip1 = Submarine::getEquipment(input.getStr(4));
   }
 
-//-----------------------------------------------------------------------------
-public: // Command::Printable implementaion
-  std::string toString() const override {
-    return Msg(TYPE) << getTurnNumber() << getSubID()
-                     << dirLetter << Submarine::equipmentName(equip);
-  }
-
-//-----------------------------------------------------------------------------
-public: // getters
-  Direction getDirection() const noexcept {
-    return dir;
-  }
-
-  Submarine::Equipment getEquip() const noexcept {
-    return equip;
+  MoveCommand(const unsigned playerID,
+              const unsigned turnNumber,
+              const unsigned subID,
+              const Direction direction,
+              const Submarine::Equipment equip)
+    : Command(Command::Move, playerID, turnNumber, subID)
+  {
+    dir = direction;
+    equip1 = equip;
   }
 };
 
@@ -35,11 +35,11 @@ public: // constructors
     }
   }
 
-//-----------------------------------------------------------------------------
-public: // Command::Printable implementaion
-  std::string toString() const override {
-    return Msg(TYPE) << getTurnNumber() << getSubID();
-  }
+  PingCommand(const unsigned playerID,
+              const unsigned turnNumber,
+              const unsigned subID)
+    : Command(Command::Ping, playerID, turnNumber, subID)
+  { }
 };
 
 } // namespace subsim
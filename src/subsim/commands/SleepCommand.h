@@ -19,11 +19,6 @@ class SleepCommand : public Command {
 public: // constants
   static const char TYPE = 'S';
 
-//-----------------------------------------------------------------------------
-private: // variables
-  Submarine::Equipment equip1;
-  Submarine::Equipment equip2;
-
 //-----------------------------------------------------------------------------
 public: // constructors
   SleepCommand() = delete;
@@ -42,22 +37,15 @@ public: // constructors
     equip2 = Submarine::getEquipment(input.getStr(4));
   }
 
-//-----------------------------------------------------------------------------
-public: // Command::Printable implementaion
-  std::string toString() const override {
-    return Msg(TYPE) << getTurnNumber() << getSubID()
-                     << Submarine::equipmentName(equip1)
-                     << Submarine::equipmentName(equip2);
-  }
-
-//-----------------------------------------------------------------------------
-public: // getters
-  Submarine::Equipment getEquip1() const noexcept {
-    return equip1;
-  }
-
-  Submarine::Equipment getEquip2() const noexcept {
-    return equip2;
+  SleepCommand(const unsigned playerID,
+               const unsigned turnNumber,
+               const unsigned subID,
+               const Submarine::Equipment first,
+               const Submarine::Equipment second)
+    : Command(Command::Sleep, playerID, turnNumber, subID)
+  {
+    equip1 = first;
+    equip2 = second;
   }
 };
 
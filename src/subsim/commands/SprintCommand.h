@@ -20,12 +20,6 @@ class SprintCommand : public Command {
 public: // constants
   static const char TYPE = 'R';
 
-//-----------------------------------------------------------------------------
-private: // variables
-  char dirLetter;
-  unsigned dist;
-  Direction dir;
-
 //-----------------------------------------------------------------------------
 public: // constructors
   SprintCommand() = delete;
@@ -40,45 +34,21 @@ public: // constructors
     if (input.getFieldCount() != 5) {
       throw Error("Sprint command requires 4 values");
     }
-    const std::string str = input.getStr(3);
-    if (str.size() != 1) {
-      throw Error("Invalid direction: " + str);
-    }
-    switch (dirLetter = str[0]) {
-    case 'E':
-      dir = Direction::East;
-      break;
-    case 'N':
-      dir = Direction::North;
-      break;
-    case 'S':
-      dir = Direction::South;
-      break;
-    case 'W':
-      dir = Direction::West;
-      break;
-    default:
-      throw Error("Invalid direction: " + str);
-    }
-    if ((dist = input.getUInt(3)) < 2) {
-      throw Error("Invalid distance: " + input.getStr(3));
+    dir = parseDirection(input.getStr(3));
+    if ((distance = input.getUInt(4)) < 2) {
+      throw Error("Invalid distance: " + input.getStr(4));
     }
   }
 
-//-----------------------------------------------------------------------------
-public: // Command::Printable implementaion
-  std::string toString() const override {
-    return Msg(TYPE) << getTurnNumber() << getSubID() << dirLetter << dist;
-  }
-
-//-----------------------------------------------------------------------------
-public: // getters
-  Direction getDirection() const noexcept {
-    return dir;
-  }
-
-  unsigned getDistance() const noexcept {
-    return dist;
+  SprintCommand(const unsigned playerID,
+                const unsigned turnNumber,
+                const unsigned subID,
+                const Direction direction,
+                const unsigned dist)
+    : Command(Command::Sprint, playerID, turnNumber, subID)
+  {
+    dir = direction;
+    distance = dist;
   }
 };
 
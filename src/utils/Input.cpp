@@ -2,16 +2,64 @@
 // Copyright (c) 2017 Shawn Chidester, All rights reserved
 //-----------------------------------------------------------------------------
 #include "Input.h"
-#include "CSVReader.h"
 #include "Error.h"
 #include "Logger.h"
 #include "Msg.h"
 #include "StringUtils.h"
-#include <sys/select.h>
+#include <cstring>
+#include <type_traits>
 
 namespace subsim
 {
 
+//-----------------------------------------------------------------------------
+// same results as isInt()/toInt32() and isUInt()/toUInt32() on a trimmed
+// string, without building the string
+template<typename T>
+static T parseNumber(const char* p, const char* end, const T def) noexcept {
+  const bool sign = ((p < end) && ((*p == '+') ||
+                                   (std::is_signed<T>::value && (*p == '-'))));
+  const char* digits = (p + sign);
+  if ((digits >= end) || !isdigit(static_cast<unsigned char>(*digits))) {
+    return def;
+  }
+
+  T result = 0;
+  for (const char* d = digits; d < end; ++d) {
+    const unsigned char ch = static_cast<unsigned char>(*d);
+    if (isspace(ch)) {
+      break;
+    } else if ((ch == '.') || (ch == '+') ||
+               (std::is_signed<T>::value && (ch == '-')))
+    {
+      return def; // not a number at all
+    } else if (!isdigit(ch)) {
+      return 0; // a number followed by garbage
+    }
+    const T tmp = ((10 * result) + (ch - '0'));
+    if (tmp < result) {
+      return 0;
+    }
+    result = tmp;
+  }
+  return ((sign && (*p == '-')) ? -result : result);
+}
+
+//-----------------------------------------------------------------------------
+Input::Input() {
+  if ((epollFd = epoll_create1(EPOLL_CLOEXEC)) < 0) {
+    throw Error(Msg() << "Input epoll_create1 failed: " << toError(errno));
+  }
+}
+
+//-----------------------------------------------------------------------------
+Input::~Input() noexcept {
+  if (epollFd >= 0) {
+    ::close(epollFd);
+    epollFd = -1;
+  }
+}
+
 //-----------------------------------------------------------------------------
 char
 Input::readChar(const int fd) {
@@ -24,8 +72,8 @@ Input::readChar(const int fd) {
     throw Error(Msg() << "Input.readChar() failed: " << toError(errno));
   }
 
-  Logger::debug() << "Received character '" << ch << "' from channel " << fd
-                  << " " << getHandleLabel(fd);
+  LOG_DEBUG << "Received character '" << ch << "' from channel " << fd
+            << " " << getHandleLabel(fd);
   return ch;
 }
 
@@ -104,57 +152,53 @@ Input::readKey(const int fd, char& ch) {
 //-----------------------------------------------------------------------------
 bool
 Input::waitForData(std::set<int>& ready, const int timeout_ms) {
+  std::set<int> writable;
+  return waitForData(ready, writable, timeout_ms) && ready.size();
+}
+
+//-----------------------------------------------------------------------------
+bool
+Input::waitForData(std::set<int>& ready,
+                   std::set<int>& writable,
+                   const int timeout_ms)
+{
   ready.clear();
+  writable.clear();
   if (handles.empty()) {
     Logger::warn() << "No input handles specified to wait for";
     return false;
   }
 
-  fd_set set;
-  FD_ZERO(&set);
+  // lines already buffered are ready without asking the kernel
+  if (buffered.size() || unpollable.size()) {
+    ready = buffered;
+    ready.insert(unpollable.begin(), unpollable.end());
+    return true;
+  }
 
-  int maxFd = -1;
-  for (auto it = handles.begin(); it != handles.end(); ++it) {
-    const int fd = it->first;
-    if (fd >= 0) {
-      if (buffer.count(fd) && (pos[fd] < len[fd])) {
-        ready.insert(fd);
-      } else {
-        maxFd = std::max<int>(maxFd, fd);
-        FD_SET(fd, &set);
-      }
+  if (events.size() < handles.size()) {
+    events.resize(handles.size());
+  }
+
+  int ret = epoll_wait(epollFd, events.data(), events.size(), timeout_ms);
+  if (ret < 0) {
+    if (errno == EINTR) {
+      LOG_DEBUG << "Input epoll_wait interrupted";
+      return false;
     }
+    throw Error(Msg() << "Input epoll_wait failed: " << toError(errno));
   }
 
-  if (ready.empty() && (maxFd >= 0)) {
-    struct timeval tv;
-    tv.tv_sec = (timeout_ms / 1000);
-    tv.tv_usec = ((timeout_ms % 1000) * 10);
-
-    int ret = 0;
-    while (true) {
-      ret = select((maxFd + 1), &set, nullptr, nullptr,
-                   ((timeout_ms < 0) ? nullptr : &tv));
-      if (ret < 0) {
-        if (errno == EINTR) {
-          Logger::debug() << "Input select interrupted";
-          return false;
-        }
-        throw Error(Msg() << "Input select failed: " << toError(errno));
-      }
-      break;
+  for (int i = 0; i < ret; ++i) {
+    if (events[i].events & (EPOLLIN | EPOLLERR | EPOLLHUP)) {
+      ready.insert(events[i].data.fd);
     }
-    if (ret) {
-      for (auto it = handles.begin(); it != handles.end(); ++it) {
-        const int fd = it->first;
-        if (FD_ISSET(fd, &set)) {
-          ready.insert(fd);
-        }
-      }
+    if (events[i].events & EPOLLOUT) {
+      writable.insert(events[i].data.fd);
     }
   }
 
-  return ready.size();
+  return (ready.size() || writable.size());
 }
 
 //-----------------------------------------------------------------------------
@@ -164,50 +208,73 @@ Input::readln(const int fd, const char delimeter) {
     throw Error(Msg() << "Input readln() invalid handle: " << fd);
   }
 
-  line[0] = 0;
+  lineHandle = fd;
+  lineData = nullptr;
+  lineSize = 0;
+  linePending = false;
   fields.clear();
-  if (buffer.find(fd) == buffer.end()) {
-    buffer[fd].resize(BUFFER_SIZE, 0);
-    pos[fd] = 0;
-    len[fd] = 0;
+
+  Channel& channel = channels[fd];
+  if (channel.data.empty()) {
+    channel.data.resize(BUFFER_SIZE, 0);
   }
 
-  unsigned n = 0;
-  while (n < (BUFFER_SIZE - 1)) {
-    if (pos[fd] >= len[fd]) {
-      if (!bufferData(fd)) {
-        return 0;
-      }
-    }
-    if (!len[fd]) {
+  const char* newLine = nullptr;
+  while (true) {
+    const char* begin = (channel.data.data() + channel.begin);
+    const unsigned avail = (channel.end - channel.begin);
+    if ((newLine = static_cast<const char*>(memchr(begin, '\n', avail)))) {
+      lineSize = static_cast<unsigned>(newLine - begin + 1);
       break;
-    } else if ((pos[fd] < len[fd]) &&
-               ((line[n++] = buffer[fd][pos[fd]++]) == '\n'))
-    {
+    } else if (avail >= (BUFFER_SIZE - 1)) {
+      lineSize = (BUFFER_SIZE - 1);
+      break;
+    }
+
+    const unsigned prevEnd = channel.end;
+    if (!bufferData(fd, channel)) {
+      buffered.erase(fd);
+      return 0;
+    } else if (channel.closed) {
+      lineSize = (channel.end - channel.begin); // take whatever is left
       break;
+    } else if (channel.end == prevEnd) {
+      linePending = true; // no more data for now, wait for the rest
+      buffered.erase(fd);
+      return 0;
     }
   }
-  line[n] = 0;
 
-  if (Logger::getInstance().getLogLevel() >= Logger::DEBUG) {
-    Logger::debug() << "Received '" << trimStr(line.data())
-                    << "' from channel " << fd << " " << getHandleLabel(fd);
+  lineData = (channel.data.data() + channel.begin);
+  channel.begin += lineSize;
+  if (channel.begin >= channel.end) {
+    channel.begin = channel.end = 0;
+    buffered.erase(fd);
+  } else if (memchr((channel.data.data() + channel.begin), '\n',
+                    (channel.end - channel.begin)))
+  {
+    buffered.insert(fd);
+  } else {
+    buffered.erase(fd); // partial line, wait for the rest
   }
 
+  LOG_DEBUG << "Received '" << getLine() << "' from channel " << fd << " "
+            << getHandleLabel(fd);
+
   unsigned newLineCount = 0;
-  for (unsigned i = 0; i < n; ++i) {
-    if ((line[0] == '\n') || (line[0] == '\r')) {
+  for (unsigned i = 0; i < lineSize; ++i) {
+    if ((lineData[i] == '\n') || (lineData[i] == '\r')) {
       newLineCount++;
     } else {
       break;
     }
   }
 
-  if (!line[0] || (newLineCount == n)) {
+  if (newLineCount == lineSize) {
     return 0;
   }
 
-  fields = CSVReader(line.data(), delimeter, true).readCells();
+  splitFields(delimeter);
   return fields.size();
 }
 
@@ -215,35 +282,80 @@ Input::readln(const int fd, const char delimeter) {
 void
 Input::addHandle(const int handle, const std::string& label) {
   if (handle >= 0) {
+    // level triggered: readln() reads at most one buffer per call and stops
+    // at a partial line, so data may be left unread after a wakeup
+    struct epoll_event event;
+    memset(&event, 0, sizeof(event));
+    event.events = EPOLLIN;
+    event.data.fd = handle;
+    if (!epoll_ctl(epollFd, EPOLL_CTL_ADD, handle, &event)) {
+      unpollable.erase(handle);
+    } else if (errno == EPERM) {
+      unpollable.insert(handle);
+    } else if ((errno != EEXIST) ||
+               epoll_ctl(epollFd, EPOLL_CTL_MOD, handle, &event))
+    {
+      throw Error(Msg() << "Input epoll_ctl(" << handle << ") failed: "
+                  << toError(errno));
+    }
     handles[handle] = label;
-    Logger::debug() << "Added channel " << handle << " " << label;
+    LOG_DEBUG << "Added channel " << handle << " " << label;
   }
 }
 
 //-----------------------------------------------------------------------------
 void
 Input::removeHandle(const int handle) {
-  Logger::debug() << "Removing channel " << handle << " "
-                  << getHandleLabel(handle);
+  LOG_DEBUG << "Removing channel " << handle << " "
+            << getHandleLabel(handle);
 
   auto i1 = handles.find(handle);
   if (i1 != handles.end()) {
     handles.erase(i1);
+    // fails harmlessly if the handle has already been closed
+    epoll_ctl(epollFd, EPOLL_CTL_DEL, handle, nullptr);
   }
+  buffered.erase(handle);
+  unpollable.erase(handle);
+  writeWatch.erase(handle);
 
-  auto i2 = buffer.find(handle);
-  if (i2 != buffer.end()) {
-    buffer.erase(i2);
+  auto i2 = channels.find(handle);
+  if (i2 != channels.end()) {
+    channels.erase(i2);
   }
 
-  auto i3 = pos.find(handle);
-  if (i3 != pos.end()) {
-    pos.erase(i3);
+  // the current line and fields point into the buffer just released
+  if (handle == lineHandle) {
+    lineHandle = -1;
+    lineData = nullptr;
+    lineSize = 0;
+    linePending = false;
+    fields.clear();
   }
+}
 
-  auto i4 = len.find(handle);
-  if (i4 != len.end()) {
-    len.erase(i4);
+//-----------------------------------------------------------------------------
+void
+Input::watchWritable(const int handle, const bool enable) {
+  if (!handles.count(handle) || unpollable.count(handle) ||
+      (writeWatch.count(handle) == enable))
+  {
+    return;
+  }
+
+  struct epoll_event event;
+  memset(&event, 0, sizeof(event));
+  event.events = (enable ? (EPOLLIN | EPOLLOUT) : EPOLLIN);
+  event.data.fd = handle;
+  if (epoll_ctl(epollFd, EPOLL_CTL_MOD, handle, &event)) {
+    throw Error(Msg() << "Input epoll_ctl(" << handle << ") failed: "
+                << toError(errno));
+  }
+
+  if (enable) {
+    writeWatch.insert(handle);
+  } else {
+    writeWatch.erase(handle);
   }
 }
 
@@ -253,6 +365,15 @@ Input::containsHandle(const int handle) const {
   return ((handle >= 0) && (handles.count(handle) > 0));
 }
 
+//-----------------------------------------------------------------------------
+// true if readln() can return a complete line from the handle's buffer
+// without reading from the handle
+//-----------------------------------------------------------------------------
+bool
+Input::hasLine(const int handle) const {
+  return (buffered.count(handle) > 0);
+}
+
 //-----------------------------------------------------------------------------
 std::string
 Input::getHandleLabel(const int handle) const {
@@ -278,34 +399,39 @@ Input::getFieldCount() const noexcept {
 //-----------------------------------------------------------------------------
 std::string
 Input::getLine(const bool trim) const {
-  return trim ? trimStr(line.data()) : std::string(line.data());
+  if (!lineData) {
+    return std::string();
+  }
+  const std::string str(lineData, lineSize);
+  return trim ? trimStr(str) : str;
 }
 
 //-----------------------------------------------------------------------------
 std::string
 Input::getStr(const unsigned index,
               const std::string& def,
-              const bool trim) const
+              const bool /*trim*/) const
 {
-  if (index >= fields.size()) {
-    return def;
-  } else {
-    return trim ? trimStr(fields.at(index)) : fields.at(index);
-  }
+  // fields are trimmed by splitFields()
+  const Field* field = getField(index);
+  return field ? std::string(field->data, field->size) : def;
 }
 
 //-----------------------------------------------------------------------------
 int
 Input::getInt(const unsigned index, const int def) const {
-  const std::string str = getStr(index);
-  return isInt(str) ? toInt32(str) : def;
+  const Field* field = getField(index);
+  return field ? parseNumber<int>(field->data, (field->data + field->size), def)
+               : def;
 }
 
 //-----------------------------------------------------------------------------
 unsigned
 Input::getUInt(const unsigned index, const unsigned def) const {
-  const std::string str = getStr(index);
-  return isUInt(str) ? toUInt32(str) : def;
+  const Field* field = getField(index);
+  return field
+      ? parseNumber<unsigned>(field->data, (field->data + field->size), def)
+      : def;
 }
 
 //-----------------------------------------------------------------------------
@@ -317,26 +443,66 @@ Input::getDouble(const unsigned index, const double def) const {
 
 //-----------------------------------------------------------------------------
 bool
-Input::bufferData(const int fd) {
-  pos[fd] = len[fd] = 0;
-  while (len[fd] < BUFFER_SIZE) {
-    ssize_t n = read(fd, buffer[fd].data(), BUFFER_SIZE);
+Input::bufferData(const int fd, Channel& channel) {
+  // make room behind the unread data
+  if (channel.begin) {
+    const unsigned avail = (channel.end - channel.begin);
+    memmove(channel.data.data(), (channel.data.data() + channel.begin), avail);
+    channel.begin = 0;
+    channel.end = avail;
+  }
+
+  while (true) {
+    ssize_t n = read(fd, (channel.data.data() + channel.end),
+                     (BUFFER_SIZE - channel.end));
     if (n < 0) {
       if (errno == EINTR) {
-        Logger::debug() << "Input read interrupted, retrying";
+        LOG_DEBUG << "Input read interrupted, retrying";
         continue;
+      } else if ((errno == EAGAIN) || (errno == EWOULDBLOCK)) {
+        return true; // no more data for now
       } else {
         Logger::error() << "Input read failed: " << toError(errno);
         return false;
       }
-    } else if (n <= BUFFER_SIZE) {
-      len[fd] = n;
-      break;
+    } else if (n == 0) {
+      channel.closed = true;
+      return true;
+    } else if (n <= (BUFFER_SIZE - channel.end)) {
+      channel.end += n;
+      return true;
     } else {
       throw Error("Input buffer overflow!");
     }
   }
-  return true;
+}
+
+//-----------------------------------------------------------------------------
+void
+Input::splitFields(const char delimeter) {
+  // same splitting as CSVReader with trim enabled: a delimiter at the very
+  // end of the line does not start another field
+  const char* p = lineData;
+  const char* end = (lineData + lineSize);
+  while (p < end) {
+    const char* next = delimeter
+        ? static_cast<const char*>(memchr(p, delimeter, (end - p)))
+        : nullptr;
+    if (!next) {
+      next = end;
+    }
+
+    const char* first = p;
+    const char* last = next;
+    while ((first < last) && isspace(static_cast<unsigned char>(*first))) {
+      ++first;
+    }
+    while ((last > first) && isspace(static_cast<unsigned char>(last[-1]))) {
+      --last;
+    }
+    fields.push_back(Field { first, static_cast<unsigned>(last - first) });
+    p = (next + 1);
+  }
 }
 
 } // namespace subsim
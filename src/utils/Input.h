@@ -5,6 +5,7 @@
 #define SUBSIM_INPUT_H
 
 #include "Platform.h"
+#include <sys/epoll.h>
 
 namespace subsim
 {
@@ -31,24 +32,50 @@ public: // enums
     BUFFER_SIZE = 4096
   };
 
+//-----------------------------------------------------------------------------
+private: // types
+  struct Field {
+    const char* data;
+    unsigned size;
+  };
+
+  // lines are framed in place, a partial line left at the end is moved to
+  // the front before the next read so every line stays contiguous
+  struct Channel {
+    std::vector<char> data;
+    unsigned begin = 0;
+    unsigned end = 0;
+    bool closed = false; // end of stream reached
+  };
+
 //-----------------------------------------------------------------------------
 private: // variables
   char lastChar = 0;
-  std::vector<char> line;
-  std::vector<std::string> fields;
+  int epollFd = -1;
+  int lineHandle = -1;
+  const char* lineData = nullptr; // points into the channel of lineHandle
+  unsigned lineSize = 0;
+  bool linePending = false; // last readln() stopped at a partial line
+  std::vector<Field> fields;
+  std::vector<struct epoll_event> events;
   std::map<int, std::string> handles;
-  std::map<int, std::vector<char>> buffer;
-  std::map<int, unsigned> pos;
-  std::map<int, unsigned> len;
+  std::map<int, Channel> channels;
+  std::set<int> buffered; // handles with a complete line in buffer
+  std::set<int> unpollable; // regular files, always ready (as with select)
+  std::set<int> writeWatch; // handles also polled for writability
 
 //-----------------------------------------------------------------------------
 public: // constructors
-  Input() : line(BUFFER_SIZE, 0) { }
+  Input();
   Input(Input&&) = delete;
   Input(const Input&) = delete;
   Input& operator=(Input&&) = delete;
   Input& operator=(const Input&) = delete;
 
+//-----------------------------------------------------------------------------
+public: // destructor
+  ~Input() noexcept;
+
 //-----------------------------------------------------------------------------
 public: // methods
   /**
@@ -79,7 +106,9 @@ public: // methods
    * @brief Block execution until timeout or data becomes available for reading
    *
    * Wait for data to become available for reading on one or more of the
-   * handles added via this::addHandle()
+   * handles added via this::addHandle().  Handles stay registered with an
+   * epoll instance between calls, so the cost of each call depends on the
+   * number of ready handles rather than the number of registered handles.
    *
    * @param[out] ready Populated with handles that have data available
    * @param timeout_ms max milliseconds to wait, -1 = wait indefinitely
@@ -87,16 +116,39 @@ public: // methods
    */
   bool waitForData(std::set<int>& ready, const int timeout_ms = -1);
 
+  /**
+   * @brief Same as above, but also report handles that have become writable
+   *
+   * Only handles enabled via this::watchWritable() are reported writable.
+   *
+   * @param[out] ready Populated with handles that have data available
+   * @param[out] writable Populated with watched handles that can be written
+   * @param timeout_ms max milliseconds to wait, -1 = wait indefinitely
+   * @return true if any handle is ready or writable, otherwise false
+   */
+  bool waitForData(std::set<int>& ready,
+                   std::set<int>& writable,
+                   const int timeout_ms = -1);
+
   /**
    * @brief Read one line of data from the given handle
    *
-   * Read data from given handle up to whichever of these comes first:
+   * Lines are framed in the handle's buffer, which is refilled from the
+   * handle only when it doesn't already hold a complete line.  A line ends
+   * at whichever of these comes first:
    *
    *  * the first new-line character
    *  * (BUFFER_SIZE - 1) bytes
-   *  * no more data available
+   *  * the end of the stream
+   *
+   * A non-blocking handle that runs out of data before the line is complete
+   * returns 0 without consuming anything and this::isLinePending() reports
+   * true, the partial line is kept until the rest arrives.  Blocking
+   * handles wait for the rest of the line.
    *
-   * Then split the data into fields using the specified delimiter.
+   * The line is split into fields using the specified delimiter.
+   * Fields refer to the handle's buffer rather than copies of it, they
+   * stay valid until the next readln() on the same handle or its removal.
    * You can the get individual field values via:
    *
    *  * this::getStr(fieldIndex)
@@ -112,7 +164,10 @@ public: // methods
 
   void addHandle(const int handle, const std::string& label = "");
   void removeHandle(const int handle);
+  void watchWritable(const int handle, const bool enable);
   bool containsHandle(const int handle) const;
+  bool hasLine(const int handle) const;
+  bool isLinePending() const noexcept { return linePending; }
   unsigned getHandleCount() const noexcept;
   unsigned getFieldCount() const noexcept;
 
@@ -128,7 +183,11 @@ public: // methods
 
 //-----------------------------------------------------------------------------
 private: // methods
-  bool bufferData(const int fd);
+  bool bufferData(const int fd, Channel&);
+  void splitFields(const char delimeter);
+  const Field* getField(const unsigned index) const noexcept {
+    return (index < fields.size()) ? &fields[index] : nullptr;
+  }
 };
 
 } // namespace subsim
@@ -6,16 +6,32 @@
 
 #include "Platform.h"
 #include <iostream>
+#include <mutex>
 
 namespace subsim
 {
 
+//-----------------------------------------------------------------------------
+// Holds a process wide lock from construction until the line is finished so
+// lines logged by different threads never interleave.  The lock is recursive
+// because values being logged may log something themselves.  The stream is
+// only flushed after the line if flush is set, otherwise the line stays in
+// the stream's buffer until something else flushes it.
 //-----------------------------------------------------------------------------
 class LogStream {
 //-----------------------------------------------------------------------------
 private: // variables
   std::ostream* stream = nullptr;
   bool print = false;
+  bool flush = true;
+  std::unique_lock<std::recursive_mutex> lock;
+
+//-----------------------------------------------------------------------------
+private: // static methods
+  static std::recursive_mutex& mutex() {
+    static std::recursive_mutex instance;
+    return instance;
+  }
 
 //-----------------------------------------------------------------------------
 public: // constructors
@@ -26,12 +42,15 @@ public: // constructors
   LogStream& operator=(const LogStream&) = delete;
 
   explicit LogStream(std::ostream* stream,
-                     const std::string& hdr = "",
-                     const bool print = false)
+                     const char* hdr = nullptr,
+                     const bool print = false,
+                     const bool flush = true)
     : stream(stream),
-      print(print && (stream != &(std::cerr)))
+      print(print && (stream != &(std::cerr))),
+      flush(flush),
+      lock(mutex())
   {
-    if (hdr.size()) {
+    if (hdr && (*hdr)) {
       if (stream) {
         (*stream) << hdr;
       }
@@ -45,8 +64,10 @@ public: // constructors
 public: // destructor
   ~LogStream() {
     if (stream) {
-      (*stream) << std::endl;
-      stream->flush();
+      (*stream) << '\n';
+      if (flush) {
+        stream->flush();
+      }
     }
     if (print) {
       std::cerr << std::endl;
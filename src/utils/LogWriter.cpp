@@ -0,0 +1,184 @@
+//-----------------------------------------------------------------------------
+// Copyright (c) 2017 Shawn Chidester, All Rights Reserved.
+//-----------------------------------------------------------------------------
+#include "LogWriter.h"
+#include "Logger.h"
+#include "StringUtils.h"
+#include <fcntl.h>
+#include <cstring>
+
+namespace subsim
+{
+
+//-----------------------------------------------------------------------------
+LogWriter::Buffer::int_type
+LogWriter::Buffer::overflow(int_type ch) {
+  drain(writer.pending);
+  if (!traits_type::eq_int_type(ch, traits_type::eof())) {
+    writer.pending += traits_type::to_char_type(ch);
+  }
+  if (writer.pending.size() >= COMMIT_SIZE) {
+    writer.commit();
+  }
+  return traits_type::not_eof(ch);
+}
+
+//-----------------------------------------------------------------------------
+std::streamsize
+LogWriter::Buffer::xsputn(const char* data, std::streamsize count) {
+  if (count <= (epptr() - pptr())) {
+    memcpy(pptr(), data, count);
+    pbump(static_cast<int>(count));
+  } else {
+    drain(writer.pending);
+    writer.collect(data, count);
+  }
+  return count;
+}
+
+//-----------------------------------------------------------------------------
+int
+LogWriter::Buffer::sync() {
+  writer.commit();
+  return 0;
+}
+
+//-----------------------------------------------------------------------------
+LogWriter::LogWriter()
+  : std::ostream(nullptr),
+    buffer(*this)
+{
+  rdbuf(&buffer);
+  setstate(std::ios_base::badbit); // until opened
+}
+
+//-----------------------------------------------------------------------------
+bool
+LogWriter::open(const std::string& name, const bool syncEnabled) {
+  close();
+
+  fd = ::open(name.c_str(), (O_WRONLY | O_CREAT | O_APPEND | O_CLOEXEC),
+              0644);
+  if (fd < 0) {
+    Logger::error() << "Failed to open '" << name << "': " << toError(errno);
+    return false;
+  }
+
+  fileName = name;
+  sync = syncEnabled;
+  stopping = failed = false;
+  queued = done = 0;
+  clear();
+  thread = std::thread(&LogWriter::run, this);
+  return true;
+}
+
+//-----------------------------------------------------------------------------
+void
+LogWriter::collect(const char* data, const std::size_t count) {
+  pending.append(data, count);
+  if (pending.size() >= COMMIT_SIZE) {
+    commit();
+  }
+}
+
+//-----------------------------------------------------------------------------
+// Hand everything collected since the last commit to the writer thread,
+// and wait for it to reach the disk if sync is enabled
+//-----------------------------------------------------------------------------
+void
+LogWriter::commit() {
+  buffer.drain(pending);
+  if (!isOpen()) {
+    pending.clear();
+    return;
+  }
+
+  std::unique_lock<std::mutex> lock(mutex);
+  if (pending.size()) {
+    queue.emplace_back();
+    queue.back().swap(pending);
+    queued++;
+    wakeup.notify_one();
+  }
+  if (sync) {
+    const uint64_t target = queued;
+    written.wait(lock, [&] { return ((done >= target) || failed); });
+  }
+  if (failed) {
+    setstate(std::ios_base::badbit);
+  }
+}
+
+//-----------------------------------------------------------------------------
+void
+LogWriter::close() {
+  if (!isOpen()) {
+    return;
+  }
+
+  commit();
+  {
+    std::lock_guard<std::mutex> lock(mutex);
+    stopping = true;
+  }
+  wakeup.notify_one();
+  thread.join();
+
+  ::close(fd);
+  fd = -1;
+  fileName.clear();
+  setstate(std::ios_base::badbit);
+}
+
+//-----------------------------------------------------------------------------
+// Everything queued when the thread wakes is written with one write() call
+// per buffer and, in sync mode, one fdatasync() for the lot
+//-----------------------------------------------------------------------------
+void
+LogWriter::run() {
+  std::vector<std::string> batch;
+  std::unique_lock<std::mutex> lock(mutex);
+  while (true) {
+    wakeup.wait(lock, [this] { return (stopping || queue.size()); });
+    if (queue.empty()) {
+      break; // stopping and nothing left to write
+    }
+
+    batch.swap(queue);
+    const uint64_t target = queued;
+    lock.unlock();
+
+    bool ok = true;
+    for (const std::string& data : batch) {
+      const char* p = data.data();
+      std::size_t remain = data.size();
+      while (ok && remain) {
+        const ssize_t n = ::write(fd, p, remain);
+        if (n > 0) {
+          p += n;
+          remain -= n;
+        } else if ((n < 0) && (errno == EINTR)) {
+          continue;
+        } else {
+          Logger::error() << "Failed to write '" << fileName << "': "
+                          << toError(errno);
+          ok = false;
+        }
+      }
+    }
+    if (ok && sync && fdatasync(fd)) {
+      Logger::error() << "Failed to sync '" << fileName << "': "
+                      << toError(errno);
+      ok = false;
+    }
+    batch.clear();
+
+    lock.lock();
+    done = target;
+    failed = (failed || !ok);
+    written.notify_all();
+  }
+}
+
+} // namespace subsim
@@ -0,0 +1,116 @@
+//-----------------------------------------------------------------------------
+// Copyright (c) 2017 Shawn Chidester, All Rights Reserved.
+//-----------------------------------------------------------------------------
+#ifndef SUBSIM_LOG_WRITER_H
+#define SUBSIM_LOG_WRITER_H
+
+#include "Platform.h"
+#include <condition_variable>
+#include <mutex>
+#include <ostream>
+#include <thread>
+
+namespace subsim
+{
+
+//-----------------------------------------------------------------------------
+// An output stream for log files that never blocks the thread writing to it
+// on disk I/O.  Formatted output collects in memory until flush() (or
+// std::endl) hands it to a background thread that appends it to the file.
+// Collecting more than COMMIT_SIZE bytes hands it over too.  Write '\n'
+// rather than std::endl and flush once per batch of lines, such as a turn.
+//
+// With sync enabled flush() waits until everything handed over so far is
+// written and on disk (fdatasync), so nothing done after a flush can be
+// seen by anyone before the log records it.
+//-----------------------------------------------------------------------------
+class LogWriter : public std::ostream {
+//-----------------------------------------------------------------------------
+public: // enums
+  enum {
+    COMMIT_SIZE = (256 * 1024)
+  };
+
+//-----------------------------------------------------------------------------
+private: // types
+  class Buffer : public std::streambuf {
+    LogWriter& writer;
+    char area[4096];
+
+  public:
+    explicit Buffer(LogWriter& writer) noexcept
+      : writer(writer)
+    {
+      setp(area, (area + sizeof(area)));
+    }
+
+    void drain(std::string& dest) {
+      dest.append(pbase(), (pptr() - pbase()));
+      setp(area, (area + sizeof(area)));
+    }
+
+  protected:
+    int_type overflow(int_type ch) override;
+    std::streamsize xsputn(const char* data, std::streamsize count) override;
+    int sync() override;
+  };
+
+//-----------------------------------------------------------------------------
+private: // variables
+  Buffer buffer;
+  std::string fileName;
+  std::string pending; // collected since the last commit, game thread only
+  int fd = -1;
+  bool sync = false;
+
+  std::thread thread;
+  std::mutex mutex;
+  std::condition_variable wakeup;
+  std::condition_variable written;
+  std::vector<std::string> queue; // guarded by mutex
+  uint64_t queued = 0;            // commits handed over, guarded by mutex
+  uint64_t done = 0;              // commits written, guarded by mutex
+  bool stopping = false;          // guarded by mutex
+  bool failed = false;            // guarded by mutex
+
+//-----------------------------------------------------------------------------
+public: // constructors
+  LogWriter();
+  LogWriter(LogWriter&&) = delete;
+  LogWriter(const LogWriter&) = delete;
+  LogWriter& operator=(LogWriter&&) = delete;
+  LogWriter& operator=(const LogWriter&) = delete;
+
+//-----------------------------------------------------------------------------
+public: // destructor
+  ~LogWriter() { close(); }
+
+//-----------------------------------------------------------------------------
+public: // methods
+  bool isOpen() const noexcept { return (fd >= 0); }
+  bool isSynced() const noexcept { return sync; }
+  const std::string& getFileName() const noexcept { return fileName; }
+
+  /**
+   * @brief Open the given file for appending and start the writer thread
+   * @param fileName The file to append log output to
+   * @param sync If true flush() waits until output is on disk
+   * @return false if the file could not be opened
+   */
+  bool open(const std::string& fileName, const bool sync = false);
+
+  /**
+   * @brief Flush, wait for the writer thread to finish, and close the file
+   */
+  void close();
+
+//-----------------------------------------------------------------------------
+private: // methods
+  void collect(const char* data, const std::size_t count);
+  void commit();
+  void run();
+};
+
+} // namespace subsim
+
+#endif // SUBSIM_LOG_WRITER_H
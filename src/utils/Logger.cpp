@@ -4,6 +4,7 @@
 #include "Logger.h"
 #include "CommandArgs.h"
 #include "StringUtils.h"
+#include <fcntl.h>
 
 namespace subsim
 {
@@ -48,9 +49,7 @@ Logger::Logger()
 
 //-----------------------------------------------------------------------------
 Logger::~Logger() {
-  if (fileStream.is_open()) {
-    fileStream.close();
-  }
+  fileBuffer.close();
 }
 
 //-----------------------------------------------------------------------------
@@ -58,21 +57,87 @@ Logger&
 Logger::setLogFile(const std::string& file) {
   stream = &std::cerr;
   logFile.clear();
-  try {
-    if (fileStream.is_open()) {
-      fileStream.close();
-    }
-    if (file.size()) {
-      fileStream.open(file.c_str(), (std::ofstream::out|std::ofstream::app));
+  fileBuffer.close();
+  if (file.size()) {
+    if (fileBuffer.open(file)) {
       stream = &fileStream;
       logFile = file;
+    } else {
+      error() << "Cannot open " << file << ": " << toError(errno);
     }
-  } catch (const std::exception& e) {
-    error() << "Cannot open " << file << ": " << e.what();
   }
   return (*this);
 }
 
+//-----------------------------------------------------------------------------
+bool
+Logger::FileBuffer::open(const std::string& path) {
+  close();
+  fd = ::open(path.c_str(), (O_WRONLY | O_CREAT | O_APPEND | O_CLOEXEC),
+              0644);
+  return (fd >= 0);
+}
+
+//-----------------------------------------------------------------------------
+void
+Logger::FileBuffer::close() {
+  if (fd >= 0) {
+    write(data.size());
+    ::close(fd);
+    fd = -1;
+  }
+  data.clear();
+}
+
+//-----------------------------------------------------------------------------
+Logger::FileBuffer::int_type
+Logger::FileBuffer::overflow(int_type ch) {
+  if (!traits_type::eq_int_type(ch, traits_type::eof())) {
+    const char c = traits_type::to_char_type(ch);
+    xsputn(&c, 1);
+  }
+  return traits_type::not_eof(ch);
+}
+
+//-----------------------------------------------------------------------------
+// Once the buffer is full everything up to the last complete line goes out
+//-----------------------------------------------------------------------------
+std::streamsize
+Logger::FileBuffer::xsputn(const char* str, std::streamsize count) {
+  data.append(str, count);
+  if (data.size() >= FILE_BUFFER_SIZE) {
+    const std::size_t eol = data.rfind('\n');
+    if (eol != std::string::npos) {
+      write(eol + 1);
+    }
+  }
+  return count;
+}
+
+//-----------------------------------------------------------------------------
+int
+Logger::FileBuffer::sync() {
+  write(data.size());
+  return 0;
+}
+
+//-----------------------------------------------------------------------------
+void
+Logger::FileBuffer::write(const std::size_t count) {
+  std::size_t done = 0;
+  while ((fd >= 0) && (done < count)) {
+    const ssize_t n = ::write(fd, (data.data() + done), (count - done));
+    if (n > 0) {
+      done += n;
+    } else if ((n < 0) && (errno == EINTR)) {
+      continue;
+    } else {
+      break; // nowhere left to report it
+    }
+  }
+  data.erase(0, count);
+}
+
 //-----------------------------------------------------------------------------
 Logger&
 Logger::setLogLevel(const LogLevel level) noexcept {
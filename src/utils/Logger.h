@@ -6,7 +6,29 @@
 
 #include "Platform.h"
 #include "LogStream.h"
-#include <fstream>
+#include <ostream>
+
+//-----------------------------------------------------------------------------
+// The most verbose level compiled in, statements logged through the LOG_*
+// macros below at a more verbose level are removed at compile time
+//-----------------------------------------------------------------------------
+#ifndef LOG_COMPILE_LEVEL
+#define LOG_COMPILE_LEVEL DEBUG
+#endif
+
+//-----------------------------------------------------------------------------
+// Log statements that cost one level check when their level is off, the
+// values streamed into them are not evaluated at all in that case:
+//   LOG_DEBUG << "sent " << msg;
+//-----------------------------------------------------------------------------
+#define LOG_AT(level, method) \
+  if (!subsim::Logger::isEnabled(subsim::Logger::level)) { } else \
+    subsim::Logger::method()
+
+#define LOG_ERROR LOG_AT(ERROR, error)
+#define LOG_WARN  LOG_AT(WARN, warn)
+#define LOG_INFO  LOG_AT(INFO, info)
+#define LOG_DEBUG LOG_AT(DEBUG, debug)
 
 namespace subsim
 {
@@ -22,11 +44,38 @@ public: // enums
     DEBUG
   };
 
+  enum {
+    FILE_BUFFER_SIZE = 8192
+  };
+
+//-----------------------------------------------------------------------------
+private: // types
+  // Collects log file output and appends it with write() in whole lines,
+  // so lines from other threads' loggers never land in the middle of one
+  class FileBuffer : public std::streambuf {
+    int fd = -1;
+    std::string data;
+
+  public:
+    ~FileBuffer() { close(); }
+    bool open(const std::string& path);
+    void close();
+
+  protected:
+    int_type overflow(int_type ch) override;
+    std::streamsize xsputn(const char* str, std::streamsize count) override;
+    int sync() override;
+
+  private:
+    void write(const std::size_t count);
+  };
+
 //-----------------------------------------------------------------------------
 private: // variables
   LogLevel logLevel = INFO;
   std::ostream* stream = nullptr;
-  std::ofstream fileStream;
+  FileBuffer fileBuffer;
+  std::ostream fileStream{&fileBuffer};
   std::string logFile;
 
 //-----------------------------------------------------------------------------
@@ -65,6 +114,11 @@ public: // static methods
     return getInstance().log(DEBUG, "DEBUG: ");
   }
 
+  static inline bool isEnabled(const LogLevel level) {
+    return ((level <= LOG_COMPILE_LEVEL) &&
+            (getInstance().logLevel >= level));
+  }
+
 //-----------------------------------------------------------------------------
 public: // methods
   Logger& setLogLevel(const LogLevel level) noexcept;
@@ -73,15 +127,27 @@ public: // methods
   LogLevel getLogLevel() const noexcept { return logLevel; }
   std::string getLogFile() const { return logFile; }
 
-  LogStream log(const std::string& hdr = "") const {
+  // write out lines left in the buffer, event loops call this before they
+  // wait so the log file doesn't fall behind while nothing is happening
+  void flush() {
+    if (stream) {
+      stream->flush();
+    }
+  }
+
+  LogStream log(const char* hdr = nullptr) const {
     return LogStream(stream, hdr);
   }
 
+  // lines at INFO and below are left in the buffer, anything more severe
+  // flushes them along with it
   LogStream log(const LogLevel level,
-      const std::string& hdr = nullptr,
+      const char* hdr = nullptr,
       const bool print = false) const
   {
-    return (logLevel >= level) ? LogStream(stream, hdr, print) : LogStream();
+    return ((level <= LOG_COMPILE_LEVEL) && (logLevel >= level))
+        ? LogStream(stream, hdr, print, (level < INFO))
+        : LogStream();
   }
 };
 
@@ -27,15 +27,5 @@
 #define VERIFY(expr) expr
 #endif
 
-namespace subsim {
-  inline void initRandom() noexcept {
-    srand(static_cast<unsigned>(time(nullptr) * getpid()));
-  }
-
-  inline unsigned random(const unsigned bound) noexcept {
-    return (((static_cast<unsigned>(rand() >> 3)) & 0x7FFFU) % bound);
-  }
-}
-
 #endif // SUBSIM_PLATFORM_H
 
@@ -0,0 +1,80 @@
+//-----------------------------------------------------------------------------
+// Copyright (c) 2017 Shawn Chidester, All Rights Reserved.
+//-----------------------------------------------------------------------------
+#ifndef SUBSIM_RANDOM_H
+#define SUBSIM_RANDOM_H
+
+#include "Platform.h"
+#include <ctime>
+
+namespace subsim
+{
+
+//-----------------------------------------------------------------------------
+// Seedable xorshift64* generator, each instance has its own state so
+// separate games never share (or contend on) random number state
+//-----------------------------------------------------------------------------
+class Random {
+//-----------------------------------------------------------------------------
+private: // variables
+  uint64_t seed = 0;
+  uint64_t state = 0;
+
+//-----------------------------------------------------------------------------
+public: // constructors
+  Random(Random&&) noexcept = default;
+  Random(const Random&) noexcept = default;
+  Random& operator=(Random&&) noexcept = default;
+  Random& operator=(const Random&) noexcept = default;
+
+  explicit Random(const uint64_t seed = 0) noexcept {
+    setSeed(seed);
+  }
+
+//-----------------------------------------------------------------------------
+public: // static methods
+  static uint64_t newSeed() noexcept {
+    return (static_cast<uint64_t>(time(nullptr)) * getpid());
+  }
+
+//-----------------------------------------------------------------------------
+public: // methods
+  uint64_t getSeed() const noexcept {
+    return seed;
+  }
+
+  void setSeed(const uint64_t value) noexcept {
+    // run seed through splitmix64 so small/similar seeds diverge quickly
+    uint64_t z = (seed = value) + 0x9E3779B97F4A7C15ULL;
+    z = ((z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL);
+    z = ((z ^ (z >> 27)) * 0x94D049BB133111EBULL);
+    state = (z ^ (z >> 31));
+    if (!state) {
+      state = 0x9E3779B97F4A7C15ULL; // xorshift state must be non-zero
+    }
+  }
+
+  uint64_t next() noexcept {
+    state ^= (state >> 12);
+    state ^= (state << 25);
+    state ^= (state >> 27);
+    return (state * 0x2545F4914F6CDD1DULL);
+  }
+
+  // returns value in range [0, bound)
+  unsigned operator()(const unsigned bound) noexcept {
+    return static_cast<unsigned>(((next() >> 32) * bound) >> 32);
+  }
+
+  template<typename Iterator>
+  void shuffle(Iterator begin, Iterator end) noexcept {
+    const unsigned count = static_cast<unsigned>(end - begin);
+    for (unsigned i = count; i > 1; --i) {
+      std::iter_swap((begin + (i - 1)), (begin + (*this)(i)));
+    }
+  }
+};
+
+} // namespace subsim
+
+#endif // SUBSIM_RANDOM_H
@@ -7,12 +7,14 @@
 #include "Msg.h"
 #include "StringUtils.h"
 #include <sys/ioctl.h>
+#include <atomic>
 
 namespace subsim
 {
 
 //-----------------------------------------------------------------------------
 static std::unique_ptr<Screen> instance;
+static std::atomic<bool> resizePending(false);
 
 //-----------------------------------------------------------------------------
 static Rectangle GetScreenDimensions() {
@@ -36,12 +38,28 @@ static Rectangle GetScreenDimensions() {
 //-----------------------------------------------------------------------------
 Screen&
 Screen::get(const bool update) {
-  if (update || !instance) {
+  if (!instance) {
+    resizePending = false;
     instance.reset(new Screen(GetScreenDimensions()));
+  } else if (resizePending.exchange(false) || update) {
+    instance->resize(GetScreenDimensions());
   }
   return (*instance);
 }
 
+//-----------------------------------------------------------------------------
+void
+Screen::resized() noexcept {
+  resizePending = true;
+}
+
+//-----------------------------------------------------------------------------
+std::mutex&
+Screen::getMutex() {
+  static std::mutex mutex;
+  return mutex;
+}
+
 //-----------------------------------------------------------------------------
 const char*
 Screen::colorCode(const ScreenColor color) {
@@ -69,43 +87,78 @@ Screen::colorCode(const ScreenColor color) {
 //-----------------------------------------------------------------------------
 Screen&
 Screen::clear() {
-  return str("\033[2J");
+  if (!buffered) {
+    buffered = true;
+    cursorX = cursorY = 1;
+  }
+  clearCells(0, back.size());
+  clearPending = true; // one escape sequence is cheaper than a screen of ' '
+  return (*this);
 }
 
 //-----------------------------------------------------------------------------
 Screen&
 Screen::clearLine() {
-  return str("\033[2K");
+  if (!buffered) {
+    return str("\033[2K");
+  }
+  const unsigned row = ((std::min(cursorY, getHeight()) - 1) * getWidth());
+  clearCells(row, (row + getWidth()));
+  return (*this);
 }
 
 //-----------------------------------------------------------------------------
 Screen&
 Screen::clearToLineBegin() {
-  return str("\033[1K");
+  if (!buffered) {
+    return str("\033[1K");
+  }
+  const unsigned row = ((std::min(cursorY, getHeight()) - 1) * getWidth());
+  clearCells(row, (row + std::min(cursorX, getWidth())));
+  return (*this);
 }
 
 //-----------------------------------------------------------------------------
 Screen&
 Screen::clearToLineEnd() {
-  return str("\033[0K");
+  if (!buffered) {
+    return str("\033[0K");
+  }
+  const unsigned row = ((std::min(cursorY, getHeight()) - 1) * getWidth());
+  clearCells((row + std::min(cursorX, getWidth()) - 1), (row + getWidth()));
+  return (*this);
 }
 
 //-----------------------------------------------------------------------------
 Screen&
 Screen::clearToScreenBegin() {
-  return str("\033[1J");
+  if (!buffered) {
+    return str("\033[1J");
+  }
+  const unsigned row = ((std::min(cursorY, getHeight()) - 1) * getWidth());
+  clearCells(0, (row + std::min(cursorX, getWidth())));
+  return (*this);
 }
 
 //-----------------------------------------------------------------------------
 Screen&
 Screen::clearToScreenEnd() {
-  return str("\033[0J");
+  if (!buffered) {
+    return str("\033[0J");
+  }
+  const unsigned row = ((std::min(cursorY, getHeight()) - 1) * getWidth());
+  clearCells((row + std::min(cursorX, getWidth()) - 1), back.size());
+  return (*this);
 }
 
 //-----------------------------------------------------------------------------
 Screen&
 Screen::color(const ScreenColor color) {
-  return str(colorCode(color));
+  if (!buffered) {
+    return str(colorCode(color));
+  }
+  pen = color;
+  return (*this);
 }
 
 //-----------------------------------------------------------------------------
@@ -121,7 +174,10 @@ Screen::cursor(const unsigned x, const unsigned y) {
     Logger::error() << "invalid screen coordinates: " << x << ',' << y;
     return (*this);
   }
-  return str("\033[" + toStr(y) + ';' + toStr(x) + 'H');
+  buffered = true;
+  cursorX = x;
+  cursorY = y;
+  return (*this);
 }
 
 //-----------------------------------------------------------------------------
@@ -136,6 +192,8 @@ Screen::flag(const ScreenFlag flag) {
   case ClearToLineEnd:     return clearToLineEnd();
   case ClearToScreenBegin: return clearToScreenBegin();
   case ClearToScreenEnd:   return clearToScreenEnd();
+  case SaveCursor:         return saveCursor();
+  case RestoreCursor:      return restoreCursor();
   default:
     break;
   }
@@ -145,16 +203,74 @@ Screen::flag(const ScreenFlag flag) {
 //-----------------------------------------------------------------------------
 Screen&
 Screen::flush() {
+  if (buffered) {
+    render();
+
+    // leave the terminal's cursor and color where the caller expects them,
+    // text typed at a prompt is echoed there
+    moveTo(std::min(cursorX, getWidth()), cursorY);
+    if (!termColorKnown || (termColor != pen)) {
+      emit(colorCode(pen));
+      termColor = pen;
+      termColorKnown = true;
+    }
+
+    if (output.size() && (fwrite(output.data(), output.size(), 1, stdout) != 1)) {
+      output.clear();
+      throw Error(Msg() << "Failed to print to screen: " << toError(errno));
+    }
+    output.clear();
+  }
+
   if (fflush(stdout)) {
     throw Error(Msg() << "Screen flush failed: " << toError(errno));
   }
   return (*this);
 }
 
+//-----------------------------------------------------------------------------
+// Forget what the terminal shows, the next flush() redraws every cell that
+// has been drawn.  Needed after anything else writes to the terminal, such
+// as the echo of text typed at a prompt.
+//-----------------------------------------------------------------------------
+Screen&
+Screen::invalidate() {
+  std::fill(front.begin(), front.end(), Cell { 0, DefaultColor });
+  termX = termY = 0;
+  termColorKnown = false;
+  return (*this);
+}
+
+//-----------------------------------------------------------------------------
+Screen&
+Screen::restoreCursor() {
+  if (!buffered) {
+    return str("\0338");
+  }
+  cursorX = savedX;
+  cursorY = savedY;
+  return (*this);
+}
+
+//-----------------------------------------------------------------------------
+Screen&
+Screen::saveCursor() {
+  if (!buffered) {
+    return str("\0337");
+  }
+  savedX = cursorX;
+  savedY = cursorY;
+  return (*this);
+}
+
 //-----------------------------------------------------------------------------
 Screen&
 Screen::str(const std::string& x) {
-  if (fwrite(x.c_str(), x.size(), 1, stdout) < 0) {
+  if (buffered) {
+    for (const char c : x) {
+      ch(c);
+    }
+  } else if (x.size() && (fwrite(x.c_str(), x.size(), 1, stdout) != 1)) {
     throw Error(Msg() << "Failed to print to screen: " << toError(errno));
   }
   return (*this);
@@ -163,10 +279,194 @@ Screen::str(const std::string& x) {
 //-----------------------------------------------------------------------------
 Screen&
 Screen::ch(const char x) {
-  if (x && (fputc(x, stdout) != x)) {
-    throw Error(Msg() << "Failed to print to screen: " << toError(errno));
+  if (!x) {
+    return (*this);
+  } else if (!buffered) {
+    if (fputc(x, stdout) != x) {
+      throw Error(Msg() << "Failed to print to screen: " << toError(errno));
+    }
+  } else if (x == '\n') {
+    newLine();
+  } else if (x == '\r') {
+    cursorX = 1;
+  } else {
+    put(x);
   }
   return (*this);
 }
 
+//-----------------------------------------------------------------------------
+void
+Screen::clearCells(const unsigned begin, const unsigned end) {
+  const Cell blank { ' ', DefaultColor };
+  for (unsigned i = begin; (i < end) && (i < back.size()); ++i) {
+    back[i] = blank;
+  }
+}
+
+//-----------------------------------------------------------------------------
+void
+Screen::emit(const std::string& x) {
+  output += x;
+}
+
+//-----------------------------------------------------------------------------
+// Move the terminal's cursor with the shortest sequence that will do
+//-----------------------------------------------------------------------------
+void
+Screen::moveTo(const unsigned x, const unsigned y) {
+  if ((x == termX) && (y == termY)) {
+    return;
+  }
+
+  if (termX && (y == termY) && (x > termX)) {
+    // rewriting a few known cells is shorter than any escape sequence
+    const unsigned gap = (x - termX);
+    const unsigned first = (((y - 1) * getWidth()) + termX - 1);
+    bool rewrite = (gap <= 3);
+    for (unsigned i = 0; rewrite && (i < gap); ++i) {
+      const Cell& cell = front[first + i];
+      rewrite = (cell.ch && (cell == back[first + i]) &&
+                 termColorKnown && (cell.color == termColor));
+    }
+    if (rewrite) {
+      for (unsigned i = 0; i < gap; ++i) {
+        output += front[first + i].ch;
+      }
+    } else {
+      emit("\033[" + toStr(gap) + 'C');
+    }
+  } else if (termY && (x == 1) && (y == (termY + 1))) {
+    emit("\r\n"); // termY < y <= height, so this never scrolls
+  } else {
+    emit("\033[" + toStr(y) + ';' + toStr(x) + 'H');
+  }
+  termX = x;
+  termY = y;
+}
+
+//-----------------------------------------------------------------------------
+void
+Screen::newLine() {
+  cursorX = 1;
+  if (cursorY < getHeight()) {
+    cursorY++;
+  } else {
+    scroll();
+  }
+}
+
+//-----------------------------------------------------------------------------
+void
+Screen::put(const char x) {
+  if (cursorX > getWidth()) {
+    newLine(); // the terminal wraps at the right edge
+  }
+  back[((cursorY - 1) * getWidth()) + cursorX - 1] = Cell { x, pen };
+  cursorX++;
+}
+
+//-----------------------------------------------------------------------------
+// Append what it takes to bring the terminal up to date with the back buffer
+//-----------------------------------------------------------------------------
+void
+Screen::render() {
+  if (clearPending) {
+    clearPending = false;
+    emit("\033[2J");
+    std::fill(front.begin(), front.end(), Cell { ' ', DefaultColor });
+  }
+
+  const Cell blank { ' ', DefaultColor };
+  const unsigned width = getWidth();
+  unsigned tail = 0; // blank cells from here to the end of the row
+  for (unsigned i = 0; i < back.size(); ++i) {
+    if (!(i % width)) {
+      for (tail = (i + width); (tail > i) && (back[tail - 1] == blank); ) {
+        --tail;
+      }
+    }
+
+    const Cell& cell = back[i];
+    if (!cell.ch || (cell == front[i])) {
+      continue;
+    }
+
+    if (i >= tail) {
+      // erase the rest of the row with one escape sequence
+      moveTo(((i % width) + 1), ((i / width) + 1));
+      if (!termColorKnown || (termColor != DefaultColor)) {
+        emit(colorCode(DefaultColor));
+        termColor = DefaultColor;
+        termColorKnown = true;
+      }
+      emit("\033[K");
+      const unsigned rowEnd = ((i / width) + 1) * width;
+      std::fill((front.begin() + i), (front.begin() + rowEnd), blank);
+      i = (rowEnd - 1);
+      continue;
+    }
+
+    moveTo(((i % width) + 1), ((i / width) + 1));
+    if (!termColorKnown || (cell.color != termColor)) {
+      emit(colorCode(cell.color));
+      termColor = cell.color;
+      termColorKnown = true;
+    }
+    output += cell.ch;
+    front[i] = cell;
+
+    // the cursor stays put after writing the last column, until the
+    // next character wraps it, so don't assume where it is
+    if (++termX > width) {
+      termX = termY = 0;
+    }
+  }
+}
+
+//-----------------------------------------------------------------------------
+void
+Screen::resize(const Rectangle& dimensions) {
+  // keep what's been drawn where it still fits, the terminal may have
+  // rearranged what it shows so all of it gets redrawn
+  const unsigned oldWidth = getWidth();
+  const unsigned oldHeight = getHeight();
+  std::vector<Cell> old;
+  old.swap(back);
+
+  set(dimensions.getTopLeft(), dimensions.getBottomRight());
+  back.assign(getSize(), Cell { 0, DefaultColor });
+  front.assign(getSize(), Cell { 0, DefaultColor });
+  for (unsigned y = 0; (y < oldHeight) && (y < getHeight()); ++y) {
+    for (unsigned x = 0; (x < oldWidth) && (x < getWidth()); ++x) {
+      back[(y * getWidth()) + x] = old[(y * oldWidth) + x];
+    }
+  }
+  cursorX = std::min(cursorX, getWidth());
+  cursorY = std::min(cursorY, getHeight());
+  savedX = std::min(savedX, getWidth());
+  savedY = std::min(savedY, getHeight());
+  termX = termY = 0;
+  termColorKnown = false;
+  clearPending = false;
+}
+
+//-----------------------------------------------------------------------------
+// A new line at the bottom scrolls the terminal, scroll both buffers with it
+//-----------------------------------------------------------------------------
+void
+Screen::scroll() {
+  render();
+  moveTo(1, getHeight());
+  emit("\n");
+
+  const unsigned width = getWidth();
+  back.erase(back.begin(), (back.begin() + width));
+  back.resize(getSize(), Cell { 0, DefaultColor });
+  front.erase(front.begin(), (front.begin() + width));
+  front.resize(getSize(), Cell { ' ', DefaultColor });
+  termX = 1;
+  savedY = std::max<unsigned>(1, (savedY - 1));
+}
+
 } // namespace subsim
@@ -8,6 +8,7 @@
 #include "Coordinate.h"
 #include "Printable.h"
 #include "Rectangle.h"
+#include <mutex>
 
 namespace subsim
 {
@@ -40,11 +41,50 @@ enum ScreenFlag {
   ClearToLineBegin,
   ClearToLineEnd,
   ClearToScreenBegin,
-  ClearToScreenEnd
+  ClearToScreenEnd,
+  SaveCursor,
+  RestoreCursor
 };
 
+//-----------------------------------------------------------------------------
+// Text is streamed straight to the terminal until the cursor is first
+// positioned (or the screen cleared).  From then on drawing goes into a back
+// buffer of cells and flush() writes only the cells that differ from what
+// the terminal is known to show, moving the cursor as little as possible.
+// Redrawing an unchanged frame costs nothing but the comparison.
 //-----------------------------------------------------------------------------
 class Screen : public Rectangle {
+//-----------------------------------------------------------------------------
+private: // types
+  struct Cell {
+    char ch; // 0 = never drawn (back) or unknown (front)
+    ScreenColor color;
+
+    bool operator==(const Cell& other) const noexcept {
+      return ((ch == other.ch) && (color == other.color));
+    }
+    bool operator!=(const Cell& other) const noexcept {
+      return !((*this) == other);
+    }
+  };
+
+//-----------------------------------------------------------------------------
+private: // variables
+  bool buffered = false;
+  bool clearPending = false;
+  bool termColorKnown = false;
+  unsigned cursorX = 1;
+  unsigned cursorY = 1;
+  unsigned savedX = 1;
+  unsigned savedY = 1;
+  unsigned termX = 0; // where the terminal's cursor is, 0 = unknown
+  unsigned termY = 0;
+  ScreenColor pen = DefaultColor;
+  ScreenColor termColor = DefaultColor;
+  std::vector<Cell> back;  // what should be on the terminal
+  std::vector<Cell> front; // what is on the terminal
+  std::string output;      // escape sequences and text not yet written
+
 //-----------------------------------------------------------------------------
 private: // constructors
   Screen() = delete;
@@ -53,9 +93,9 @@ private: // constructors
   Screen& operator=(Screen&&) = delete;
   Screen& operator=(const Screen&) = delete;
 
-  explicit Screen(const Rectangle& container)
-    : Rectangle(container)
-  { }
+  explicit Screen(const Rectangle& container) {
+    resize(container);
+  }
 
 //-----------------------------------------------------------------------------
 public: // static methods
@@ -63,6 +103,13 @@ public: // static methods
   static Screen& print() { return get(false); }
   static const char* colorCode(const ScreenColor);
 
+  // hold while drawing when more than one thread draws to the screen,
+  // so one thread's cursor motion can't land in the middle of another's
+  static std::mutex& getMutex();
+
+  // async signal safe, the new size is picked up by the next get()
+  static void resized() noexcept;
+
 //-----------------------------------------------------------------------------
 public: // methods
   Screen& ch(const char);
@@ -77,6 +124,9 @@ public: // methods
   Screen& cursor(const unsigned x, const unsigned y);
   Screen& flag(const ScreenFlag);
   Screen& flush();
+  Screen& invalidate();
+  Screen& restoreCursor();
+  Screen& saveCursor();
   Screen& str(const std::string&);
 
   Screen& operator<<(const ScreenColor x) { return color(x); }
@@ -99,6 +149,17 @@ public: // operator overloads
   Screen& operator<<(const T& x) {
     return str(toStr(x));
   }
+
+//-----------------------------------------------------------------------------
+private: // methods
+  void clearCells(const unsigned begin, const unsigned end);
+  void emit(const std::string&);
+  void moveTo(const unsigned x, const unsigned y);
+  void newLine();
+  void put(const char);
+  void render();
+  void resize(const Rectangle&);
+  void scroll();
 };
 
 } // namespace subsim
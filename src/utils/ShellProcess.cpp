@@ -9,12 +9,26 @@
 #include "Msg.h"
 #include "StringUtils.h"
 #include <csignal>
+#include <poll.h>
+#include <sys/ioctl.h>
 #include <sys/stat.h>
 #include <sys/wait.h>
 
 namespace subsim
 {
 
+//-----------------------------------------------------------------------------
+// Milliseconds left until the deadline, -1 (no limit) if timeout is negative
+//-----------------------------------------------------------------------------
+static int pollTimeout(const Timestamp deadline,
+                       const Milliseconds timeout) noexcept
+{
+  if (timeout < 0) {
+    return -1;
+  }
+  return static_cast<int>(std::max<Milliseconds>(0, (deadline - Timer::now())));
+}
+
 //-----------------------------------------------------------------------------
 std::string
 ShellProcess::joinStr(const std::vector<std::string>& strings) {
@@ -75,6 +89,7 @@ ShellProcess::ShellProcess(const IOType ioType,
 //-----------------------------------------------------------------------------
 void
 ShellProcess::close() noexcept {
+  partial.clear();
   inPipe.close();
   outPipe.close();
   errPipe.close();
@@ -164,8 +179,8 @@ ShellProcess::runChild() {
   assert(childPid == 0);
   const int pid = getpid();
   try {
-    Logger::debug() << "ShellProcess(" << alias << ").runChild(" << pid
-                    << ") started";
+    LOG_DEBUG << "ShellProcess(" << alias << ").runChild(" << pid
+              << ") started";
 
     // child only "writes" to parent err, so close "read" end of errPipe
     errPipe.closeRead();
@@ -205,8 +220,8 @@ ShellProcess::runChild() {
     }
     argv.push_back(nullptr);
 
-    Logger::debug() << "ShellProcess(" << alias << ").runChild(" << pid
-                    << ") " << shellCommand;
+    LOG_DEBUG << "ShellProcess(" << alias << ").runChild(" << pid
+              << ") " << shellCommand;
 
     execvp(shellExecutable.c_str(), argv.data());
   } catch (const std::exception& e) {
@@ -231,62 +246,84 @@ ShellProcess::readln(const Milliseconds timeout) const {
   return readln(inPipe.getReadHandle(), timeout);
 }
 
+//-----------------------------------------------------------------------------
+// The timeout is a deadline for the whole line, not just the first byte, so
+// a child that writes part of a line and stalls can't block the caller.
+// Bytes read before the deadline are kept and the next call finishes the line
 //-----------------------------------------------------------------------------
 std::string
 ShellProcess::readln(const int fd, const Milliseconds timeout)
 const {
-  timeval* tmout = nullptr;
-  timeval tv;
-  if (timeout) {
-    tv.tv_sec = (timeout / 1000);
-    tv.tv_usec = (10 * (timeout % 1000));
-    tmout = &tv;
-  }
-
   const int fd1 = Pipe::SELF_PIPE.getReadHandle();
-  const int maxFd = std::max<int>(fd, fd1);
-  fd_set fds;
-  FD_ZERO(&fds);
-  FD_SET(fd1, &fds);
-  FD_SET(fd, &fds);
+  const Timestamp deadline = timeout ? (Timer::now() + timeout) : 0;
+  struct pollfd fds[2];
+  fds[0].fd = fd1;
+  fds[0].events = POLLIN;
+  fds[1].fd = fd;
+  fds[1].events = POLLIN;
+
+  std::string& line = partial[fd];
+  while (true) {
+    int wait = -1;
+    if (deadline) {
+      const Milliseconds remaining = (deadline - Timer::now());
+      if (remaining <= 0) {
+        break;
+      }
+      wait = static_cast<int>(remaining);
+    }
 
-  int ret;
-  while ((ret = ::select((maxFd + 1), &fds, nullptr, nullptr, tmout))) {
+    const int ret = ::poll(fds, 2, wait);
     if (ret < 0) {
       if (errno == EINTR) {
         continue;
       } else {
         throw Error(Msg() << "ShellProcess(" << alias << ").readln(" << fd
-                    << ") select failed: " << toError(errno));
+                    << ") poll failed: " << toError(errno));
       }
+    } else if (!ret) {
+      break;
     }
 
-    if (FD_ISSET(fd1, &fds)) {
+    if (fds[0].revents) {
       char sbuf[4096];
       ssize_t n;
-      while ((n = ::read(fd, sbuf, sizeof(sbuf))) > 0) {
+      while ((n = ::read(fd1, sbuf, (sizeof(sbuf) - 1))) > 0) {
         sbuf[n] = 0;
-        Logger::debug() << "SelfPipe: " << trimStr(sbuf);
+        LOG_DEBUG << "SelfPipe: " << trimStr(sbuf);
       }
     }
 
-    if (FD_ISSET(fd, &fds)) {
-      std::string line;
-      char ch = 0;
-      // TODO figure how to do non-blocking read
-      //      otherwise timeout only works until we start reading
-      while ((::read(fd, &ch, 1) == 1) && (ch != '\n')) {
-        line += ch;
+    if (fds[1].revents) {
+      // one byte at a time so nothing past the new-line is consumed,
+      // but only as many bytes as are already there so it can't block
+      int avail = 0;
+      if (ioctl(fd, FIONREAD, &avail) || (avail < 1)) {
+        avail = 1; // end of file or error, read() will say which
+      }
+      bool done = false;
+      for (char ch = 0; !done && (avail > 0); --avail) {
+        if (::read(fd, &ch, 1) != 1) {
+          done = true; // end of file
+        } else if (ch == '\n') {
+          done = true;
+        } else {
+          line += ch;
+        }
+      }
+      if (done) {
+        std::string result;
+        result.swap(line);
+        LOG_DEBUG << "ShellProcess(" << alias << ").readln(" << childPid
+                  << ") received: '" << result << "'";
+        return result;
       }
-      Logger::debug() << "ShellProcess(" << alias << ").readln(" << childPid
-                      << ") received: '" << line << "'";
-      return line;
     }
   }
 
-  Logger::debug() << "ShellProcess(" << alias
-                  << ").waitForExit(" << childPid
-                  << ") timeout";
+  LOG_DEBUG << "ShellProcess(" << alias
+            << ").readln(" << childPid
+            << ") timeout, " << line.size() << " bytes pending";
   return "";
 }
 
@@ -295,8 +332,8 @@ void
 ShellProcess::runParent() {
   ASSERT(childPid > 0);
 
-  Logger::debug() << "ShellProcess(" << alias << ").runParent(" << childPid
-                  << ") started";
+  LOG_DEBUG << "ShellProcess(" << alias << ").runParent(" << childPid
+            << ") started";
 
   // parent only "reads" from inPipe, so close the "write" end of the pipe
   inPipe.closeWrite();
@@ -340,8 +377,8 @@ ShellProcess::sendln(const std::string& line) const {
     data += '\n';
   }
 
-  Logger::debug() << "ShellProcess(" << alias << ").sendln(" << childPid
-                  << ") '" << line << "'";
+  LOG_DEBUG << "ShellProcess(" << alias << ").sendln(" << childPid
+            << ") '" << line << "'";
 
   outPipe.writeln(data);
 }
@@ -382,22 +419,20 @@ ShellProcess::waitForExit(const Milliseconds timeout) noexcept {
 
   exitStatus = -1;
 
-  timeval tv;
-  tv.tv_sec = (timeout / 1000);
-  tv.tv_usec = (10 * (timeout % 1000));
-
   const int fd = Pipe::SELF_PIPE.getReadHandle();
-  fd_set fds;
-  FD_ZERO(&fds);
-  FD_SET(fd, &fds);
+  struct pollfd pfd;
+  pfd.fd = fd;
+  pfd.events = POLLIN;
 
+  // the timeout covers the whole wait, not each wakeup on the self pipe
+  const Timestamp deadline = (Timer::now() + timeout);
   int ret;
-  while ((ret = ::select((fd + 1), &fds, nullptr, nullptr, &tv))) {
+  while ((ret = ::poll(&pfd, 1, pollTimeout(deadline, timeout)))) {
     if (ret < 0) {
       try {
-        Logger::debug() << "ShellProcess(" << alias
-                        << ").waitForExit(" << childPid
-                        << ") select failed: " << toError(errno);
+        LOG_DEBUG << "ShellProcess(" << alias
+                  << ").waitForExit(" << childPid
+                  << ") poll failed: " << toError(errno);
       } catch (...) { }
       if (errno == EINTR) {
         continue;
@@ -408,10 +443,10 @@ ShellProcess::waitForExit(const Milliseconds timeout) noexcept {
 
     char sbuf[4096];
     ssize_t n;
-    while ((n = ::read(fd, sbuf, sizeof(sbuf))) > 0) {
+    while ((n = ::read(fd, sbuf, (sizeof(sbuf) - 1))) > 0) {
       try {
         sbuf[n] = 0;
-        Logger::debug() << "SelfPipe: " << trimStr(sbuf);
+        LOG_DEBUG << "SelfPipe: " << trimStr(sbuf);
       } catch (...) { }
     }
 
@@ -429,17 +464,17 @@ ShellProcess::waitForExit(const Milliseconds timeout) noexcept {
 
   if (ret == 0) {
     try {
-      Logger::debug() << "ShellProcess(" << alias
-                      << ").waitForExit(" << childPid
-                      << ") timeout";
+      LOG_DEBUG << "ShellProcess(" << alias
+                << ").waitForExit(" << childPid
+                << ") timeout";
     } catch (...) { }
     return false;
   }
 
   try {
-    Logger::debug() << "ShellProcess(" << alias
-                    << ").waitForExit(" << childPid
-                    << ") child exit status = " << exitStatus;
+    LOG_DEBUG << "ShellProcess(" << alias
+              << ").waitForExit(" << childPid
+              << ") child exit status = " << exitStatus;
   } catch (...) { }
   childPid = -1;
   return true;
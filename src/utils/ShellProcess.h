@@ -33,6 +33,7 @@ private: // variables
   Pipe inPipe;
   Pipe outPipe;
   Pipe errPipe; // TODO add interface(s) to use errPipe
+  mutable std::map<int, std::string> partial; // line cut off by timeout
 
 //-----------------------------------------------------------------------------
 public: // constructors
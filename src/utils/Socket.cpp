@@ -101,7 +101,7 @@ Socket::send(const std::string& msg) const {
   std::string tmp(msg);
   tmp += '\n';
 
-  Logger::debug() << (*this) << ".send(" << tmp.size() << "," << msg << ')';
+  LOG_DEBUG << (*this) << ".send(" << tmp.size() << "," << msg << ')';
 
   size_t n = ::send(handle, tmp.c_str(), tmp.size(), MSG_NOSIGNAL);
   if (n != tmp.size()) {
@@ -112,6 +112,76 @@ Socket::send(const std::string& msg) const {
   return true;
 }
 
+//-----------------------------------------------------------------------------
+// Send pre-formatted, new-line terminated data from multiple buffers with as
+// few system calls as possible (normally one), empty buffers are skipped.
+// Never blocks: stops when the kernel send buffer is full and reports how
+// many bytes were accepted so the caller can keep the rest for later.
+//-----------------------------------------------------------------------------
+bool
+Socket::send(const struct iovec* iov,
+             const unsigned count,
+             size_t& sent) const
+{
+  sent = 0;
+  if ((handle < 0) || (mode == Server)) {
+    Logger::error() << "send(iovec[" << count << "]) called on " << (*this);
+    return false;
+  } else if (count > MAX_IOV) {
+    throw Error(Msg() << (*this) << ".send() too many buffers: " << count);
+  }
+
+  // copy non-empty buffers so short writes can be resumed
+  struct iovec vec[MAX_IOV];
+  unsigned used = 0;
+  size_t total = 0;
+  for (unsigned i = 0; i < count; ++i) {
+    if (iov[i].iov_len) {
+      vec[used++] = iov[i];
+      total += iov[i].iov_len;
+    }
+  }
+
+  LOG_DEBUG << (*this) << ".send(" << total << " bytes in "
+            << used << " buffers)";
+
+  struct msghdr msg;
+  memset(&msg, 0, sizeof(msg));
+  msg.msg_iov = vec;
+  msg.msg_iovlen = used;
+
+  while (msg.msg_iovlen) {
+    ssize_t n = ::sendmsg(handle, &msg, (MSG_NOSIGNAL | MSG_DONTWAIT));
+    if (n < 0) {
+      if (errno == EINTR) {
+        continue;
+      } else if ((errno == EAGAIN) || (errno == EWOULDBLOCK)) {
+        LOG_DEBUG << (*this) << ".send() would block after " << sent
+                  << " of " << total << " bytes";
+        break;
+      }
+      Logger::error() << (*this) << ".send(" << total << " bytes) failed: "
+                      << toError(errno);
+      return false;
+    }
+
+    // advance past whatever was written, a short write leaves the rest
+    sent += n;
+    while (msg.msg_iovlen && (static_cast<size_t>(n) >=
+                              msg.msg_iov->iov_len))
+    {
+      n -= msg.msg_iov->iov_len;
+      msg.msg_iov++;
+      msg.msg_iovlen--;
+    }
+    if (n) {
+      msg.msg_iov->iov_base = (static_cast<char*>(msg.msg_iov->iov_base) + n);
+      msg.msg_iov->iov_len -= n;
+    }
+  }
+  return true;
+}
+
 //-----------------------------------------------------------------------------
 void
 Socket::close() noexcept {
@@ -146,10 +216,13 @@ Socket::accept() const {
     memset(&addr, 0, sizeof(addr));
     socklen_t len = sizeof(addr);
 
-    const int newHandle = ::accept(handle, (sockaddr*)&addr, &len);
+    // connections are non-blocking so a client that sends part of a line
+    // (or reads slowly) never stalls the server
+    const int newHandle = ::accept4(handle, (sockaddr*)&addr, &len,
+                                    SOCK_NONBLOCK);
     if (newHandle < 0) {
       if (errno == EINTR) {
-        Logger::debug() << (*this) << ".accept() interrupted, trying again";
+        LOG_DEBUG << (*this) << ".accept() interrupted, trying again";
         continue;
       } else if ((errno == EAGAIN) || (errno == EWOULDBLOCK)) {
         return Socket();
@@ -163,7 +236,7 @@ Socket::accept() const {
     }
 
     Socket sock(inet_ntoa(addr.sin_addr), port, newHandle);
-    Logger::debug() << (*this) << ".accept() " << sock;
+    LOG_DEBUG << (*this) << ".accept() " << sock;
     return std::move(sock);
   }
 }
@@ -219,7 +292,7 @@ Socket::connect(const std::string& hostAddress,
   port = hostPort;
   mode = Client;
 
-  Logger::info() << (*this) << " connected";
+  LOG_INFO << (*this) << " connected";
   return (*this);
 }
 
@@ -274,7 +347,7 @@ Socket::listen(const std::string& bindAddress,
   port = bindPort;
   mode = Server;
 
-  Logger::info() << (*this) << " listening";
+  LOG_INFO << (*this) << " listening";
   return (*this);
 }
 
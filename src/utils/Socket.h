@@ -6,12 +6,17 @@
 
 #include "Platform.h"
 #include "Printable.h"
+#include <sys/uio.h>
 
 namespace subsim
 {
 
 //-----------------------------------------------------------------------------
 class Socket : public Printable {
+//-----------------------------------------------------------------------------
+public: // constants
+  static const unsigned MAX_IOV = 8; // max buffers per send(iovec) call
+
 //-----------------------------------------------------------------------------
 private: // variables
   std::string label;
@@ -65,6 +70,7 @@ public: // methods
   void setLabel(const std::string& value) { label = value; }
 
   bool send(const std::string&) const;
+  bool send(const struct iovec*, const unsigned count, size_t& sent) const;
   void close() noexcept;
   Socket accept() const;
   Socket& connect(const std::string& hostAddress, const int port);
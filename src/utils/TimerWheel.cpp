@@ -0,0 +1,96 @@
+//-----------------------------------------------------------------------------
+// Copyright (c) 2017 Shawn Chidester, All Rights Reserved.
+//-----------------------------------------------------------------------------
+#include "TimerWheel.h"
+#include <climits>
+
+namespace subsim
+{
+
+//-----------------------------------------------------------------------------
+TimerWheel::TimerWheel(const Milliseconds resolution,
+                       const unsigned slotCount,
+                       const Timestamp startTime)
+  : resolution(std::max<Milliseconds>(1, resolution)),
+    slots(std::max<unsigned>(1, slotCount)),
+    current(startTime)
+{ }
+
+//-----------------------------------------------------------------------------
+TimerWheel::TimerID
+TimerWheel::schedule(const Timestamp deadline) {
+  // deadlines already passed go in the current slot
+  const Milliseconds offset = (deadline > current)
+      ? ((deadline - current) / resolution)
+      : 0;
+
+  const TimerID id = ++lastID;
+  slots[(cursor + offset) % slots.size()].push_back(Entry { id, deadline });
+  pending.insert(id);
+  return id;
+}
+
+//-----------------------------------------------------------------------------
+int
+TimerWheel::nextTimeout(const Timestamp now) const {
+  if (pending.empty()) {
+    return -1;
+  }
+
+  // the first slot with a timer due this revolution holds the next deadline
+  Timestamp next = Timer::BAD_TIME;
+  Timestamp slotEnd = current;
+  for (unsigned i = 0; i < slots.size(); ++i) {
+    slotEnd += resolution;
+    for (const Entry& entry : slots[(cursor + i) % slots.size()]) {
+      if (pending.count(entry.id) &&
+          ((next == Timer::BAD_TIME) || (entry.deadline < next)))
+      {
+        next = entry.deadline;
+      }
+    }
+    if ((next != Timer::BAD_TIME) && (next < slotEnd)) {
+      break;
+    }
+  }
+
+  if (next <= now) {
+    return 0;
+  }
+  return static_cast<int>(std::min<Milliseconds>((next - now), INT_MAX));
+}
+
+//-----------------------------------------------------------------------------
+void
+TimerWheel::expire(std::vector<TimerID>& expired, const Timestamp now) {
+  expired.clear();
+  if (now < current) {
+    return;
+  }
+
+  // visit every slot passed since the last call, at most one revolution
+  const Milliseconds steps = ((now - current) / resolution);
+  const unsigned visits = static_cast<unsigned>(
+      std::min<Milliseconds>(steps, (slots.size() - 1))) + 1;
+
+  for (unsigned i = 0; i < visits; ++i) {
+    std::vector<Entry>& slot = slots[(cursor + i) % slots.size()];
+    auto keep = slot.begin();
+    for (const Entry& entry : slot) {
+      if (!pending.count(entry.id)) {
+        continue; // cancelled
+      } else if (entry.deadline <= now) {
+        expired.push_back(entry.id);
+        pending.erase(entry.id);
+      } else {
+        (*keep++) = entry;
+      }
+    }
+    slot.erase(keep, slot.end());
+  }
+
+  cursor = static_cast<unsigned>((cursor + steps) % slots.size());
+  current += (steps * resolution);
+}
+
+} // namespace subsim
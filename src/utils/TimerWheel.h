@@ -0,0 +1,84 @@
+//-----------------------------------------------------------------------------
+// Copyright (c) 2017 Shawn Chidester, All Rights Reserved.
+//-----------------------------------------------------------------------------
+#ifndef SUBSIM_TIMER_WHEEL_H
+#define SUBSIM_TIMER_WHEEL_H
+
+#include "Platform.h"
+#include "Timer.h"
+
+namespace subsim
+{
+
+//-----------------------------------------------------------------------------
+// Hashed timing wheel.  Each timer is placed in the slot its deadline falls
+// in, timers more than one revolution out share slots with nearer ones and
+// are simply skipped until their deadline passes.  Scheduling, cancelling,
+// and expiring are constant time per timer, and nextTimeout() gives an event
+// loop the number of milliseconds it may sleep before the next slot is due.
+//-----------------------------------------------------------------------------
+class TimerWheel {
+//-----------------------------------------------------------------------------
+public: // typedefs
+  typedef uint64_t TimerID;
+
+//-----------------------------------------------------------------------------
+public: // constants
+  static const TimerID NO_TIMER = 0;
+  static const Milliseconds DEFAULT_RESOLUTION = 10;
+  static const unsigned DEFAULT_SLOTS = 256;
+
+//-----------------------------------------------------------------------------
+private: // types
+  struct Entry {
+    TimerID id;
+    Timestamp deadline;
+  };
+
+//-----------------------------------------------------------------------------
+private: // variables
+  Milliseconds resolution;
+  std::vector<std::vector<Entry>> slots;
+  std::set<TimerID> pending; // cancelled timers are dropped from here only
+  Timestamp current; // start of the slot at cursor
+  unsigned cursor = 0;
+  TimerID lastID = NO_TIMER;
+
+//-----------------------------------------------------------------------------
+public: // constructors
+  TimerWheel(TimerWheel&&) = default;
+  TimerWheel(const TimerWheel&) = delete;
+  TimerWheel& operator=(TimerWheel&&) = default;
+  TimerWheel& operator=(const TimerWheel&) = delete;
+
+  explicit TimerWheel(const Milliseconds resolution = DEFAULT_RESOLUTION,
+                      const unsigned slotCount = DEFAULT_SLOTS,
+                      const Timestamp startTime = Timer::now());
+
+//-----------------------------------------------------------------------------
+public: // methods
+  bool isEmpty() const noexcept {
+    return pending.empty();
+  }
+
+  bool isPending(const TimerID id) const {
+    return pending.count(id);
+  }
+
+  unsigned size() const noexcept {
+    return pending.size();
+  }
+
+  void cancel(const TimerID id) {
+    pending.erase(id);
+  }
+
+  TimerID schedule(const Timestamp deadline);
+  int nextTimeout(const Timestamp now = Timer::now()) const;
+  void expire(std::vector<TimerID>& expired,
+              const Timestamp now = Timer::now());
+};
+
+} // namespace subsim
+
+#endif // SUBSIM_TIMER_WHEEL_H